@@ -28,7 +28,9 @@ CMAKE_INC_DIR = REPO + '/src/CmakeIncludes/'
 
 TARGETS = (
         'Model',
-        'Controller'
+        'Controller',
+        'Batch',
+        'Benchmark'
 )
 
 VSFOLDERS_FILE = 'VSFolders.cmake'
@@ -0,0 +1,187 @@
+/// @file Batch/BatchRunner.cpp
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QThread>
+#include <QThreadPool>
+
+#include "Batch/BatchRunner.h"
+#include "Controller/RendererThread.h"
+#include "Controller/TileScheduler.h"
+#include "Model/CompiledSceneFile.h"
+#include "Model/RenderTileData.h"
+#include "Model/Scene.h"
+
+#define DEFAULT_IMAGE_WIDTH 800
+#define DEFAULT_IMAGE_HEIGHT 600
+#define DEFAULT_TILE_SIZE 32
+#define DEFAULT_REFLECTION_DEEP 5
+#define DEFAULT_REFRACTION_DEEP 5
+#define DEFAULT_AA_THRESHOLD 16
+#define DEFAULT_OUTPUT_FILE "RenderedImage.png"
+
+namespace Batch
+{
+
+  BatchOptions::BatchOptions ()
+      : sceneFile(DEFAULT_SCENE_FILE_NAME), outputFile(DEFAULT_OUTPUT_FILE), imageWidth(
+          DEFAULT_IMAGE_WIDTH), imageHeight(DEFAULT_IMAGE_HEIGHT), tileSize(
+          DEFAULT_TILE_SIZE), threadCount(QThread::idealThreadCount()), reflectionDeep(
+          DEFAULT_REFLECTION_DEEP), refractionDeep(DEFAULT_REFRACTION_DEEP), shadows(
+          true), approximateMath(false), analyticAA(false), adaptiveAASamples(
+          1), adaptiveAAThreshold(DEFAULT_AA_THRESHOLD), tileOrder(
+          Controller::TileScheduler::CostOrder)
+  {
+  }
+
+  BatchRunner::BatchRunner (const BatchOptions &newOptions)
+      : options(newOptions), scene(new Model::Scene), image(
+          new Model::RenderTileData), renderParams(
+          new Controller::RenderParams), scheduler(
+          new Controller::TileScheduler), threadPool(new QThreadPool)
+  {
+    renderParams->scene = scene;
+    renderParams->allowRunning = true;
+    renderParams->shadows = options.shadows;
+    renderParams->approximateMath = options.approximateMath;
+    renderParams->analyticAA = options.analyticAA;
+    renderParams->adaptiveAASamples = options.adaptiveAASamples;
+    renderParams->adaptiveAAThreshold = options.adaptiveAAThreshold;
+    renderParams->pixelStep = 1;
+    renderParams->previousPixelStep = 0;
+    renderParams->reflectionDeep = options.reflectionDeep;
+    renderParams->refractionDeep = options.refractionDeep;
+
+    setThreadCount(options.threadCount);
+  }
+
+  BatchRunner::~BatchRunner ()
+  {
+    threadPool->waitForDone();
+  }
+
+  bool BatchRunner::init ()
+  {
+    if (!scene->init(options.sceneFile, true))
+    {
+      return false;
+    }
+
+    image->imageWidth = options.imageWidth;
+    image->imageHeight = options.imageHeight;
+    image->width = options.tileSize;
+    image->height = options.tileSize;
+    image->imageDataSize = static_cast <quint64>(image->imageWidth) * BPP
+        * image->imageHeight;
+
+    if (image->imageDataSize > IMAGE_MAX_DATA_SIZE)
+    {
+      return false;
+    }
+
+    void *mem = realloc(image->imageData,
+                        image->imageDataSize * sizeof(colorType));
+
+    if (mem == 0)
+    {
+      return false;
+    }
+    image->imageData = static_cast <colorType*>(mem);
+
+    scene->setImageWidth(image->imageWidth);
+    scene->setImageHeight(image->imageHeight);
+    scene->updateCamera();
+
+    tiles = Controller::TileScheduler::orderTiles(
+        Controller::TileScheduler::createTiles(*image), options.tileOrder);
+
+    return true;
+  }
+
+  void BatchRunner::setThreadCount (int threadCount)
+  {
+    options.threadCount = threadCount < 1 ? 1 : threadCount;
+    renderParams->maxThreadCount = options.threadCount;
+    threadPool->setMaxThreadCount(options.threadCount);
+
+    createWorkers();
+  }
+
+  void BatchRunner::createWorkers ()
+  {
+    renderers.clear();
+
+    for (int i = 0; i < options.threadCount; ++i)
+    {
+      std::shared_ptr <Controller::RendererThread> renderer(
+          new Controller::RendererThread(renderParams, scheduler.data(), i));
+      renderer->setAutoDelete(false);
+
+      renderers.append(renderer);
+    }
+  }
+
+  qint64 BatchRunner::render ()
+  {
+    QElapsedTimer timer;
+
+    renderParams->allowRunning = true;
+    scheduler->distribute(
+        tiles, renderers.size(),
+        options.tileOrder == Controller::TileScheduler::CostOrder);
+
+    for (int i = 0; i < renderers.size(); ++i)
+    {
+      renderers [i]->resetStats();
+    }
+
+    timer.start();
+
+    for (int i = 0; i < renderers.size(); ++i)
+    {
+      threadPool->start(renderers [i].get());
+    }
+
+    threadPool->waitForDone();
+
+    return timer.nsecsElapsed();
+  }
+
+  Model::RenderStats BatchRunner::getStats () const
+  {
+    Model::RenderStats stats;
+
+    for (int i = 0; i < renderers.size(); ++i)
+    {
+      stats += renderers [i]->getStats();
+    }
+
+    stats.accelerationBuildTime = scene->getAccelerationBuildTime();
+    stats.accelerationMemory =
+        scene->getAccelerationStructure().getMemoryUsage();
+
+    return stats;
+  }
+
+  bool BatchRunner::saveImage () const
+  {
+    QImage result(image->imageData, image->imageWidth, image->imageHeight,
+                  image->imageWidth * BPP, QImage::Format_RGB888);
+
+    return result.save(options.outputFile);
+  }
+
+  bool BatchRunner::saveCompiledScene () const
+  {
+    QFile file(options.compiledSceneFile);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      return false;
+    }
+
+    return Model::CompiledSceneFile::saveScene( *scene, file);
+  }
+
+} /* namespace Batch */
@@ -0,0 +1,157 @@
+/// @file Batch/BatchRunner.h
+
+#pragma once
+
+#include <QScopedPointer>
+
+#include <QList>
+#include <QString>
+
+#include <common.h>
+#include "Controller/GlobalDefines.h"
+#include "Controller/TileScheduler.h"
+#include "Model/ModelDefines.h"
+#include "Model/RenderStats.h"
+
+//Forward declarations -->
+class QThreadPool;
+
+namespace Controller
+{
+  class RendererThread;
+  struct RenderParams;
+}  // namespace Controller
+// <-- Forward declarations
+
+namespace Batch
+{
+
+  /**Options of headless rendering
+   *
+   */
+  struct BatchOptions
+  {
+      QString sceneFile;
+      QString outputFile;
+      /**If it's set, scene is compiled to this file instead of rendering
+       *
+       */
+      QString compiledSceneFile;
+      imageUnit imageWidth;
+      imageUnit imageHeight;
+      imageUnit tileSize;
+      int threadCount;
+      int reflectionDeep;
+      int refractionDeep;
+      bool shadows;
+      bool approximateMath;
+      bool analyticAA;
+      int adaptiveAASamples;
+      int adaptiveAAThreshold;
+      Controller::TileScheduler::Order tileOrder;
+
+      /**Sets default options
+       *
+       */
+      BatchOptions ();
+  };
+
+  /**Renders scene without GUI
+   * It does the same job as ThreadRunner with MainWindow, but it uses
+   * camera stored in scene file and writes image to file.
+   *
+   */
+  class BatchRunner
+  {
+    public:
+      /**Initializes rendering parameters
+       *
+       * @param newOptions rendering options
+       */
+      BatchRunner (const BatchOptions &newOptions);
+      ~BatchRunner ();
+
+      /**Loads scene and allocates memory for image
+       * It throws std::exception when scene file has errors.
+       *
+       * @return false if scene file can't be opened or image can't be allocated
+       */
+      bool init ();
+
+      /**Renders whole image with threadCount workers
+       * Ray counters are reset before rendering.
+       *
+       * @return render time in nanoseconds
+       */
+      qint64 render ();
+
+      /**Changes amount of render workers
+       * Loaded scene is kept.
+       *
+       * @param threadCount new amount of workers
+       */
+      void setThreadCount (int threadCount);
+
+      /**Returns ray counters of all workers summed up
+       *
+       * @return ray counters of last render
+       */
+      Model::RenderStats getStats () const;
+
+      /**Writes rendered image to output file
+       * Image format is deduced from file extension.
+       *
+       * @return true if image was written
+       */
+      bool saveImage () const;
+
+      /**Writes loaded scene to compiledSceneFile in compiled format
+       * It throws std::logic_error when scene can't be compiled.
+       *
+       * @return true if file was written
+       */
+      bool saveCompiledScene () const;
+
+      /**Returns rendering options
+       *
+       * @return rendering options
+       */
+      inline const BatchOptions &getOptions () const
+      {
+        return options;
+      }
+
+      /**Returns rendered scene
+       *
+       * @return scene
+       */
+      inline const Model::Scene &getScene () const
+      {
+        return *scene;
+      }
+
+    private:
+      BatchOptions options;
+
+      Model::SceneSharedPtr scene;
+      std::shared_ptr <Model::RenderTileData> image;
+      std::shared_ptr <Controller::RenderParams> renderParams;
+
+      QScopedPointer <Controller::TileScheduler> scheduler;
+      QScopedPointer <QThreadPool> threadPool;
+
+      QList <std::shared_ptr <Model::RenderTileData> > tiles;
+      QList <std::shared_ptr <Controller::RendererThread> > renderers;
+
+      /**Creates threadCount render workers
+       *
+       */
+      void createWorkers ();
+
+      /**Disables copying of object
+       *
+       */
+      Q_DISABLE_COPY (BatchRunner)
+  };
+
+} /* namespace Batch */
@@ -0,0 +1,302 @@
+/// @file Batch/main.cpp
+
+#include <cmath>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+#include "Batch/BatchRunner.h"
+#include "Controller/GlobalDefines.h"
+#include "Model/RenderStats.h"
+
+namespace
+{
+  /**Prints usage of program
+   *
+   * @param out output stream
+   */
+  void printUsage (QTextStream &out)
+  {
+    out << "Usage: Batch [options]\n"
+        << "  --scene <file>       scene file (default " DEFAULT_SCENE_FILE_NAME ")\n"
+        << "  --output <file>      output image (default RenderedImage.png)\n"
+        << "  --width <pixels>     image width\n"
+        << "  --height <pixels>    image height\n"
+        << "  --tile <pixels>      tile size\n"
+        << "  --tile-order <order> cost, random, morton, hilbert or center\n"
+        << "  --threads <count>    render thread count\n"
+        << "  --reflection <deep>  max reflection deep\n"
+        << "  --refraction <deep>  max refraction deep\n"
+        << "  --no-shadows         disable shadows\n"
+        << "  --approximate-math   approximated texture mapping\n"
+        << "  --analytic-aa        analytic anti-aliasing of sphere and plane edges\n"
+        << "  --adaptive-aa <n>    supersample edge pixels with n samples (4, 9, 16...)\n"
+        << "  --aa-threshold <d>   color difference of edge pixels (default 16)\n"
+        << "  --compile <file>     write scene in compiled format (.rtscene) and exit\n";
+  }
+
+  /**Prints render counters
+   * Counters exist only in builds with RENDER_STATS defined.
+   *
+   * @param out output stream
+   * @param stats counters to print
+   */
+  void printStats (QTextStream &out, const Model::RenderStats &stats)
+  {
+    if (!Model::RenderStats::isEnabled())
+    {
+      out << "Render stats: disabled in this build\n";
+      return;
+    }
+
+    out << "Primary rays:               " << stats.primaryRays << "\n"
+        << "Reflection rays:            " << stats.reflectionRays << "\n"
+        << "Refraction rays:            " << stats.refractionRays << "\n"
+        << "Shadow rays:                " << stats.shadowRays << "\n"
+        << "Intersection tests per ray: "
+        << QString::number(stats.getIntersectionTestsPerRay(), 'f', 2) << "\n"
+        << "Early terminations:         " << stats.earlyTerminations << "\n"
+        << "Total internal reflections: " << stats.totalInternalReflections
+        << "\n"
+        << "Texture lookups:            " << stats.textureLookups << "\n"
+        << "Acceleration build time:    "
+        << QString::number(
+            stats.accelerationBuildTime / static_cast <double>(MEGA), 'f', 2)
+        << " ms\n" << "Acceleration memory:        "
+        << stats.accelerationMemory / 1024 << " KiB\n";
+  }
+
+  /**Reads integer value of option
+   *
+   * @param arguments command line arguments
+   * @param idx index of option; it's moved to the value
+   * @param value read value
+   * @return false if value is missing or isn't a positive integer
+   */
+  bool readInt (const QStringList &arguments, int &idx, int &value)
+  {
+    bool ok = false;
+
+    if (++idx < arguments.size())
+    {
+      value = arguments [idx].toInt( &ok);
+    }
+
+    return ok && value >= 0;
+  }
+
+  /**Reads string value of option
+   *
+   * @param arguments command line arguments
+   * @param idx index of option; it's moved to the value
+   * @param value read value
+   * @return false if value is missing
+   */
+  bool readString (const QStringList &arguments, int &idx, QString &value)
+  {
+    if (++idx < arguments.size())
+    {
+      value = arguments [idx];
+      return true;
+    }
+
+    return false;
+  }
+
+  /**Reads tile order option
+   *
+   * @param arguments command line arguments
+   * @param idx index of option; it's moved to the value
+   * @param order read order
+   * @return false if value is missing or unknown
+   */
+  bool readTileOrder (const QStringList &arguments,
+                      int &idx,
+                      Controller::TileScheduler::Order &order)
+  {
+    //In order of TileScheduler::Order
+    const char * const orderNames [] =
+      { "cost", "random", "morton", "hilbert", "center" };
+    QString name;
+
+    if (!readString(arguments, idx, name))
+    {
+      return false;
+    }
+
+    for (int i = 0; i < 5; ++i)
+    {
+      if (name == orderNames [i])
+      {
+        order = static_cast <Controller::TileScheduler::Order>(i);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**Parses command line arguments
+   *
+   * @param arguments command line arguments
+   * @param options parsed options
+   * @return false on unknown option or invalid value
+   */
+  bool parseArguments (const QStringList &arguments,
+                       Batch::BatchOptions &options)
+  {
+    bool ok = true;
+
+    for (int i = 1; ok && i < arguments.size(); ++i)
+    {
+      const QString &argument = arguments [i];
+
+      if (argument == "--scene")
+      {
+        ok = readString(arguments, i, options.sceneFile);
+      }
+      else if (argument == "--output")
+      {
+        ok = readString(arguments, i, options.outputFile);
+      }
+      else if (argument == "--width")
+      {
+        ok = readInt(arguments, i, options.imageWidth)
+            && options.imageWidth > 0;
+      }
+      else if (argument == "--height")
+      {
+        ok = readInt(arguments, i, options.imageHeight)
+            && options.imageHeight > 0;
+      }
+      else if (argument == "--tile")
+      {
+        ok = readInt(arguments, i, options.tileSize) && options.tileSize > 0;
+      }
+      else if (argument == "--tile-order")
+      {
+        ok = readTileOrder(arguments, i, options.tileOrder);
+      }
+      else if (argument == "--threads")
+      {
+        ok = readInt(arguments, i, options.threadCount)
+            && options.threadCount > 0;
+      }
+      else if (argument == "--reflection")
+      {
+        ok = readInt(arguments, i, options.reflectionDeep);
+      }
+      else if (argument == "--refraction")
+      {
+        ok = readInt(arguments, i, options.refractionDeep);
+      }
+      else if (argument == "--compile")
+      {
+        ok = readString(arguments, i, options.compiledSceneFile);
+      }
+      else if (argument == "--no-shadows")
+      {
+        options.shadows = false;
+      }
+      else if (argument == "--approximate-math")
+      {
+        options.approximateMath = true;
+      }
+      else if (argument == "--analytic-aa")
+      {
+        options.analyticAA = true;
+      }
+      else if (argument == "--adaptive-aa")
+      {
+        //Samples are placed on square grid
+        ok = readInt(arguments, i, options.adaptiveAASamples);
+
+        int gridSize = static_cast <int>(std::sqrt(
+            static_cast <float>(options.adaptiveAASamples)) + 0.5f);
+
+        ok = ok && gridSize > 0
+            && gridSize * gridSize == options.adaptiveAASamples;
+      }
+      else if (argument == "--aa-threshold")
+      {
+        ok = readInt(arguments, i, options.adaptiveAAThreshold)
+            && options.adaptiveAAThreshold <= static_cast <int>(COLOR_MAX_VALUE);
+      }
+      else
+      {
+        ok = false;
+      }
+    }
+
+    return ok;
+  }
+}
+
+int main (int argc, char *argv [])
+{
+  QCoreApplication app(argc, argv);
+  QTextStream out(stdout);
+  QTextStream err(stderr);
+  Batch::BatchOptions options;
+
+  if (!parseArguments(app.arguments(), options))
+  {
+    printUsage(err);
+    return 1;
+  }
+
+  Batch::BatchRunner runner(options);
+
+  try
+  {
+    if (!runner.init())
+    {
+      err << QSTRING("Nie można otworzyć pliku sceny lub przydzielić pamięci: ")
+          << options.sceneFile << "\n";
+      return 1;
+    }
+  }
+  catch (std::exception &ex)
+  {
+    err << QSTRING("Błąd parsowania pliku sceny: ") << options.sceneFile
+        << "\n" << QSTRING(ex.what()) << "\n";
+    return 1;
+  }
+
+  if (!options.compiledSceneFile.isEmpty())
+  {
+    try
+    {
+      if (!runner.saveCompiledScene())
+      {
+        err << QSTRING("Nie można zapisać skompilowanej sceny: ")
+            << options.compiledSceneFile << "\n";
+        return 1;
+      }
+    }
+    catch (std::exception &ex)
+    {
+      err << QSTRING(ex.what()) << "\n";
+      return 1;
+    }
+
+    out << "Compiled scene: " << options.compiledSceneFile << "\n";
+    return 0;
+  }
+
+  qint64 renderTime = runner.render();
+
+  out << "Render time: "
+      << QString::number(renderTime / static_cast <double>(GIGA), 'f',
+                         TIME_PRECISION) << " s\n";
+  printStats(out, runner.getStats());
+
+  if (!runner.saveImage())
+  {
+    err << QSTRING("Nie można zapisać obrazu: ") << options.outputFile << "\n";
+    return 1;
+  }
+
+  return 0;
+}
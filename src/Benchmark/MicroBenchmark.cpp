@@ -0,0 +1,35 @@
+/// @file Benchmark/MicroBenchmark.cpp
+
+#include <QTextStream>
+
+#include "Benchmark/MicroBenchmark.h"
+#include "Controller/GlobalDefines.h"
+
+#define NAME_COLUMN_WIDTH 36
+#define VALUE_COLUMN_WIDTH 12
+
+namespace Benchmark
+{
+
+  MicroBenchmark::MicroBenchmark (qint64 newMinTime)
+      : minTime(newMinTime), sink(0)
+  {
+  }
+
+  void MicroBenchmark::print (QTextStream &out) const
+  {
+    out << QString("benchmark").leftJustified(NAME_COLUMN_WIDTH)
+        << QString("ns/op").rightJustified(VALUE_COLUMN_WIDTH)
+        << QString("M/s").rightJustified(VALUE_COLUMN_WIDTH) << "  unit\n";
+
+    for (const BenchmarkResult &result : results)
+    {
+      out << result.name.leftJustified(NAME_COLUMN_WIDTH)
+          << QString::number(result.getNsPerOperation(), 'f', 2).rightJustified(
+              VALUE_COLUMN_WIDTH)
+          << QString::number(result.getOperationsPerSecond() / MEGA, 'f', 2).rightJustified(
+              VALUE_COLUMN_WIDTH) << "  " << result.unit << "/s\n";
+    }
+  }
+
+} /* namespace Benchmark */
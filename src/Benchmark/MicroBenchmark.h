@@ -0,0 +1,132 @@
+/// @file Benchmark/MicroBenchmark.h
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+
+//Forward declarations -->
+class QTextStream;
+// <-- Forward declarations
+
+namespace Benchmark
+{
+
+  /**Result of single benchmark
+   *
+   */
+  struct BenchmarkResult
+  {
+      QString name;
+
+      /**Unit of operation, e.g. "rays"
+       *
+       */
+      QString unit;
+      qint64 operations;
+      qint64 time;
+
+      /**Returns time of single operation
+       *
+       * @return time in nanoseconds
+       */
+      inline double getNsPerOperation () const
+      {
+        return static_cast <double>(time) / operations;
+      }
+
+      /**Returns amount of operations done in one second
+       *
+       * @return operations per second
+       */
+      inline double getOperationsPerSecond () const
+      {
+        return operations * 1e9 / time;
+      }
+  };
+
+  /**Measures time of small, hot functions
+   * Function is called in batches which are doubled until a batch takes
+   * at least minimal time, so timer resolution doesn't matter.
+   *
+   */
+  class MicroBenchmark
+  {
+    public:
+      /**Sets minimal measured time of each benchmark
+       *
+       * @param newMinTime minimal time in nanoseconds
+       */
+      MicroBenchmark (qint64 newMinTime);
+
+      /**Measures given function
+       * Function is called with consecutive indices and its results
+       * are summed, so compiler can't remove the calls.
+       *
+       * @param name name of benchmark
+       * @param unit unit of operation
+       * @param function function returning float, called with operation index
+       */
+      template <typename Function>
+      void run (const QString &name, const QString &unit, Function function)
+      {
+        QElapsedTimer timer;
+        BenchmarkResult result;
+        qint64 operations = 1;
+        float sum = 0;
+
+        result.name = name;
+        result.unit = unit;
+
+        for (;;)
+        {
+          timer.start();
+
+          for (qint64 i = 0; i < operations; ++i)
+          {
+            sum += function(static_cast <int>(i));
+          }
+
+          result.time = timer.nsecsElapsed();
+
+          if (result.time >= minTime)
+          {
+            break;
+          }
+
+          operations *= 2;
+        }
+
+        result.operations = operations;
+        sink += sum;
+        results.append(result);
+      }
+
+      /**Returns results of all run benchmarks
+       *
+       * @return results
+       */
+      inline const QList <BenchmarkResult> &getResults () const
+      {
+        return results;
+      }
+
+      /**Prints results as table
+       *
+       * @param out output stream
+       */
+      void print (QTextStream &out) const;
+
+    private:
+      qint64 minTime;
+
+      /**Sum of function results
+       *
+       */
+      volatile float sink;
+
+      QList <BenchmarkResult> results;
+  };
+
+} /* namespace Benchmark */
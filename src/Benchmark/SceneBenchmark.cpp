@@ -0,0 +1,345 @@
+/// @file Benchmark/SceneBenchmark.cpp
+
+#include <cmath>
+#include <stdexcept>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include "Batch/BatchRunner.h"
+#include "Benchmark/SceneBenchmark.h"
+#include "Controller/GlobalDefines.h"
+#include "Model/Scene.h"
+
+#define BENCHMARK_IMAGE_WIDTH 800
+#define BENCHMARK_IMAGE_HEIGHT 600
+#define BENCHMARK_TILE_SIZE 32
+#define BENCHMARK_REFLECTION_DEEP 5
+#define BENCHMARK_REFRACTION_DEEP 5
+
+//Distance between centers of neighbouring lattice spheres
+#define LATTICE_OFFSET 3
+
+namespace Benchmark
+{
+
+  namespace
+  {
+    /**Escapes string for JSON
+     *
+     */
+    QString jsonString (const QString &value)
+    {
+      QString escaped(value);
+
+      escaped.replace("\\", "\\\\");
+      escaped.replace("\"", "\\\"");
+
+      return "\"" + escaped + "\"";
+    }
+
+    /**Converts nanoseconds to seconds
+     *
+     */
+    QString seconds (qint64 time)
+    {
+      return QString::number(time / static_cast <double>(GIGA), 'f',
+                             TIME_PRECISION);
+    }
+
+    /**Returns amount of rays traced in one second
+     *
+     */
+    QString perSecond (quint64 rays, qint64 time)
+    {
+      return QString::number(time > 0 ? rays * 1e9 / time : 0.0, 'f', 0);
+    }
+
+    /**Writes ray counters as JSON object
+     * Counters are divided by time if it's given, otherwise raw
+     * counters are written.
+     *
+     */
+    void writeRays (QTextStream &out,
+                    const Model::RenderStats &stats,
+                    qint64 time)
+    {
+      bool rate = time > 0;
+
+      out << "{ \"primary\": "
+          << (rate ? perSecond(stats.primaryRays, time) : QString::number(stats.primaryRays))
+          << ", \"reflection\": "
+          << (rate ? perSecond(stats.reflectionRays, time) : QString::number(stats.reflectionRays))
+          << ", \"refraction\": "
+          << (rate ? perSecond(stats.refractionRays, time) : QString::number(stats.refractionRays))
+          << ", \"shadow\": "
+          << (rate ? perSecond(stats.shadowRays, time) : QString::number(stats.shadowRays))
+          << ", \"total\": "
+          << (rate ? perSecond(stats.getTotalRays(), time) : QString::number(stats.getTotalRays()))
+          << " }";
+    }
+
+    /**Writes hot path counters as JSON object
+     *
+     */
+    void writeCounters (QTextStream &out, const Model::RenderStats &stats)
+    {
+      out << "{ \"intersectionTestsPerRay\": "
+          << QString::number(stats.getIntersectionTestsPerRay(), 'f', 2)
+          << ", \"earlyTerminations\": " << stats.earlyTerminations
+          << ", \"totalInternalReflections\": "
+          << stats.totalInternalReflections << ", \"textureLookups\": "
+          << stats.textureLookups << ", \"accelerationBuildTime\": "
+          << seconds(stats.accelerationBuildTime)
+          << ", \"accelerationMemory\": " << stats.accelerationMemory << " }";
+    }
+  }
+
+  SceneBenchmark::SceneBenchmark (int newMaxThreadCount, int newRepeatCount)
+      : maxThreadCount(newMaxThreadCount < 1 ? 1 : newMaxThreadCount), repeatCount(
+          newRepeatCount < 1 ? 1 : newRepeatCount)
+  {
+  }
+
+  void SceneBenchmark::addScene (const QString &name, const QString &fileName)
+  {
+    SceneResult result;
+
+    result.name = name;
+    result.fileName = fileName;
+    result.objectCount = 0;
+    result.loadTime = 0;
+
+    results.append(result);
+  }
+
+  bool SceneBenchmark::generateLattice (const QString &fileName,
+                                        int spheresPerAxis)
+  {
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      return false;
+    }
+
+    QTextStream out( &file);
+    int size = spheresPerAxis * LATTICE_OFFSET;
+    int half = size / 2;
+
+    //Camera sees the whole front face of lattice with 48 degree FOV
+    int cameraZ = -static_cast <int>(half / tan(RAD(24.0f))) - LATTICE_OFFSET;
+
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<scene>\n"
+        << "  <materials>\n"
+        << "    <mat id=\"0\" reflection=\"0.1\" transparency=\"0\" ior=\"1.0\" specularPower=\"50\">\n"
+        << "      <diffuseColor r=\"204\" g=\"80\" b=\"30\" />\n"
+        << "      <specularColor r=\"204\" g=\"204\" b=\"204\" />\n"
+        << "    </mat>\n"
+        << "    <mat id=\"1\" reflection=\"0.9\" transparency=\"0\" ior=\"1.0\" specularPower=\"50\">\n"
+        << "      <diffuseColor r=\"204\" g=\"204\" b=\"204\" />\n"
+        << "      <specularColor r=\"204\" g=\"204\" b=\"204\" />\n"
+        << "    </mat>\n"
+        << "    <mat id=\"2\" reflection=\"0.1\" transparency=\"0.8\" ior=\"1.4\" specularPower=\"10\">\n"
+        << "      <diffuseColor r=\"63\" g=\"204\" b=\"27\" />\n"
+        << "      <specularColor r=\"204\" g=\"204\" b=\"204\" />\n"
+        << "    </mat>\n"
+        << "  </materials>\n"
+        << "  <lights>\n"
+        << "    <light id=\"1\" power=\"1000.0\">\n"
+        << "      <position x=\"0\" y=\"" << size * 10 << "\" z=\"" << cameraZ << "\" />\n"
+        << "      <color r=\"204\" g=\"204\" b=\"204\" />\n"
+        << "    </light>\n"
+        << "    <light id=\"2\" power=\"1.0\">\n"
+        << "      <position x=\"" << half << "\" y=\"" << half << "\" z=\"" << cameraZ / 2 << "\" />\n"
+        << "      <color r=\"204\" g=\"204\" b=\"204\" />\n"
+        << "    </light>\n"
+        << "  </lights>\n"
+        << "  <objects>\n"
+        << "    <camera screenWidth=\"10\" viewDistance=\"20000\" fov=\"48\" type=\"conic\">\n"
+        << "      <direction x=\"0\" y=\"0\" z=\"0\" />\n"
+        << "      <position x=\"0\" y=\"0\" z=\"" << cameraZ << "\" />\n"
+        << "    </camera>\n"
+        << "    <sphere r=\"1.0\" material=\"0\" offset=\"" << LATTICE_OFFSET << "\">\n"
+        << "      <position x=\"" << -half << "\" y=\"" << -half << "\" z=\"0\" />\n"
+        << "      <multiply x=\"" << spheresPerAxis << "\" y=\"" << spheresPerAxis
+        << "\" z=\"" << spheresPerAxis << "\" />\n"
+        << "    </sphere>\n"
+        << "    <sphere r=\"" << half / 3 << "\" material=\"1\">\n"
+        << "      <position x=\"" << -half / 2 << "\" y=\"0\" z=\"" << cameraZ / 3 << "\" />\n"
+        << "    </sphere>\n"
+        << "    <sphere r=\"" << half / 3 << "\" material=\"2\">\n"
+        << "      <position x=\"" << half / 2 << "\" y=\"0\" z=\"" << cameraZ / 3 << "\" />\n"
+        << "    </sphere>\n"
+        << "    <plane angleX=\"0\" angleY=\"0\" angleZ=\"0\" d=\"" << -half - LATTICE_OFFSET
+        << "\" material=\"0\" />\n"
+        << "  </objects>\n"
+        << "</scene>\n";
+
+    out.flush();
+
+    return out.status() == QTextStream::Ok;
+  }
+
+  QList <int> SceneBenchmark::getThreadCounts () const
+  {
+    QList <int> threadCounts;
+
+    for (int threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+    {
+      threadCounts.append(threadCount);
+    }
+
+    threadCounts.append(maxThreadCount);
+
+    return threadCounts;
+  }
+
+  void SceneBenchmark::run (QTextStream &log)
+  {
+    for (int i = 0; i < results.size(); ++i)
+    {
+      runScene(results [i], log);
+    }
+  }
+
+  void SceneBenchmark::runScene (SceneResult &result, QTextStream &log)
+  {
+    Batch::BatchOptions options;
+    QElapsedTimer timer;
+
+    options.sceneFile = result.fileName;
+    options.imageWidth = BENCHMARK_IMAGE_WIDTH;
+    options.imageHeight = BENCHMARK_IMAGE_HEIGHT;
+    options.tileSize = BENCHMARK_TILE_SIZE;
+    options.reflectionDeep = BENCHMARK_REFLECTION_DEEP;
+    options.refractionDeep = BENCHMARK_REFRACTION_DEEP;
+    options.shadows = true;
+
+    Batch::BatchRunner runner(options);
+
+    log << result.name << ": loading " << result.fileName << "\n";
+    log.flush();
+
+    try
+    {
+      timer.start();
+
+      if (!runner.init())
+      {
+        result.error = "Scene can't be loaded";
+        return;
+      }
+
+      result.loadTime = timer.nsecsElapsed();
+    }
+    catch (std::exception &ex)
+    {
+      result.error = QString::fromUtf8(ex.what());
+      return;
+    }
+
+    result.objectCount = runner.getScene().getObjectCount();
+
+    QList <int> threadCounts = getThreadCounts();
+
+    for (int threadCount : threadCounts)
+    {
+      SceneRun run;
+
+      run.threadCount = threadCount;
+      run.time = 0;
+
+      runner.setThreadCount(threadCount);
+
+      //First render warms up caches and tile costs
+      runner.render();
+
+      for (int repeat = 0; repeat < repeatCount; ++repeat)
+      {
+        qint64 time = runner.render();
+
+        if (repeat == 0 || time < run.time)
+        {
+          run.time = time;
+          run.stats = runner.getStats();
+        }
+      }
+
+      log << result.name << ": " << threadCount << " threads, "
+          << seconds(run.time) << " s\n";
+      log.flush();
+
+      result.runs.append(run);
+    }
+  }
+
+  void SceneBenchmark::writeJson (QTextStream &out) const
+  {
+    out << "{\n"
+        << "  \"imageWidth\": " << BENCHMARK_IMAGE_WIDTH << ",\n"
+        << "  \"imageHeight\": " << BENCHMARK_IMAGE_HEIGHT << ",\n"
+        << "  \"tileSize\": " << BENCHMARK_TILE_SIZE << ",\n"
+        << "  \"reflectionDeep\": " << BENCHMARK_REFLECTION_DEEP << ",\n"
+        << "  \"refractionDeep\": " << BENCHMARK_REFRACTION_DEEP << ",\n"
+        << "  \"repeats\": " << repeatCount << ",\n"
+        << "  \"renderStats\": "
+        << (Model::RenderStats::isEnabled() ? "true" : "false") << ",\n"
+        << "  \"scenes\": [";
+
+    for (int i = 0; i < results.size(); ++i)
+    {
+      const SceneResult &result = results [i];
+
+      out << (i > 0 ? "," : "") << "\n    {\n"
+          << "      \"name\": " << jsonString(result.name) << ",\n"
+          << "      \"file\": " << jsonString(result.fileName) << ",\n";
+
+      if (!result.error.isEmpty())
+      {
+        out << "      \"error\": " << jsonString(result.error) << "\n    }";
+        continue;
+      }
+
+      out << "      \"objects\": " << result.objectCount << ",\n"
+          << "      \"loadTime\": " << seconds(result.loadTime) << ",\n"
+          << "      \"runs\": [";
+
+      //Scaling is relative to single thread render
+      qint64 singleThreadTime = result.runs.empty() ? 0 : result.runs [0].time;
+
+      for (int j = 0; j < result.runs.size(); ++j)
+      {
+        const SceneRun &run = result.runs [j];
+        double efficiency = singleThreadTime
+            / (static_cast <double>(run.time) * run.threadCount);
+
+        out << (j > 0 ? "," : "") << "\n        {\n"
+            << "          \"threads\": " << run.threadCount << ",\n"
+            << "          \"time\": " << seconds(run.time) << ",\n";
+
+        //Counters are compiled out in Release build
+        if (Model::RenderStats::isEnabled())
+        {
+          out << "          \"rays\": ";
+          writeRays(out, run.stats, 0);
+          out << ",\n          \"raysPerSecond\": ";
+          writeRays(out, run.stats, run.time);
+          out << ",\n          \"counters\": ";
+          writeCounters(out, run.stats);
+          out << ",\n";
+        }
+
+        out << "          \"scalingEfficiency\": "
+            << QString::number(efficiency, 'f', 3) << "\n        }";
+      }
+
+      out << "\n      ]\n    }";
+    }
+
+    out << "\n  ]\n}\n";
+  }
+
+} /* namespace Benchmark */
@@ -0,0 +1,113 @@
+/// @file Benchmark/SceneBenchmark.h
+
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include "Model/RenderStats.h"
+
+//Forward declarations -->
+class QTextStream;
+// <-- Forward declarations
+
+namespace Benchmark
+{
+
+  /**Render of one scene with given amount of threads
+   *
+   */
+  struct SceneRun
+  {
+      int threadCount;
+
+      /**The shortest render time of all repeats in nanoseconds
+       *
+       */
+      qint64 time;
+
+      Model::RenderStats stats;
+  };
+
+  /**All renders of one scene
+   *
+   */
+  struct SceneResult
+  {
+      QString name;
+      QString fileName;
+
+      /**Description of error; empty if scene was rendered
+       *
+       */
+      QString error;
+      int objectCount;
+      qint64 loadTime;
+      QList <SceneRun> runs;
+  };
+
+  /**Renders fixed set of scenes with fixed parameters
+   * Each scene is rendered with 1, 2, 4... threads up to maximal thread
+   * count, so scaling of renderer can be measured. Results are written
+   * as JSON.
+   *
+   */
+  class SceneBenchmark
+  {
+    public:
+      /**Sets parameters of benchmark
+       *
+       * @param newMaxThreadCount maximal amount of render threads
+       * @param newRepeatCount amount of renders of each configuration
+       */
+      SceneBenchmark (int newMaxThreadCount, int newRepeatCount);
+
+      /**Adds scene to render
+       *
+       * @param name name of scene in results
+       * @param fileName scene file
+       */
+      void addScene (const QString &name, const QString &fileName);
+
+      /**Writes scene with cubic lattice of spheres
+       * There are also mirror and glass spheres in front of lattice,
+       * so reflected and refracted rays are traced.
+       *
+       * @param fileName file to write scene to
+       * @param spheresPerAxis amount of spheres on each axis of lattice
+       * @return false if file can't be written
+       */
+      static bool generateLattice (const QString &fileName, int spheresPerAxis);
+
+      /**Renders all scenes
+       *
+       * @param log stream for progress messages
+       */
+      void run (QTextStream &log);
+
+      /**Writes results as JSON
+       *
+       * @param out output stream
+       */
+      void writeJson (QTextStream &out) const;
+
+    private:
+      int maxThreadCount;
+      int repeatCount;
+      QList <SceneResult> results;
+
+      /**Returns thread counts to render with
+       *
+       * @return 1, 2, 4... and maxThreadCount
+       */
+      QList <int> getThreadCounts () const;
+
+      /**Renders one scene with all thread counts
+       *
+       * @param result scene to render; runs are added to it
+       * @param log stream for progress messages
+       */
+      void runScene (SceneResult &result, QTextStream &log);
+  };
+
+} /* namespace Benchmark */
@@ -0,0 +1,795 @@
+/// @file Benchmark/main.cpp
+
+#include <cmath>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+#include "Benchmark/MicroBenchmark.h"
+#include "Benchmark/SceneBenchmark.h"
+#include "Controller/GlobalDefines.h"
+#include "Model/BVH.h"
+#include "Model/Color.h"
+#include "Model/FastMath.h"
+#include "Model/LatticeSphere.h"
+#include "Model/Material.h"
+#include "Model/Plane.h"
+#include "Model/Ray.h"
+#include "Model/RenderStats.h"
+#include "Model/UniformGrid.h"
+#include "Model/Sphere.h"
+#include "Model/Vector.h"
+
+//Minimal measured time of each benchmark [ns]
+#define MIN_BENCHMARK_TIME 200000000LL
+
+//Amount of prepared inputs, power of 2
+#define INPUT_COUNT 1024
+
+#define TEXTURE_SIZE 512
+
+//Inputs of each approximated function checked against libm
+#define CHECK_SAMPLE_COUNT 2000000
+
+//Rays checked against each lattice and its separate spheres
+#define CHECK_RAY_COUNT 20000
+
+//Spheres in trees of BVH benchmarks and checks
+#define BVH_SPHERE_COUNT 10000
+
+//Renders of each scene benchmark configuration
+#define SCENE_REPEAT_COUNT 3
+
+//Lattices of about 10k and 100k spheres
+#define SMALL_LATTICE_SIZE 22
+#define BIG_LATTICE_SIZE 47
+
+namespace
+{
+  typedef std::vector <Model::Ray> RayContainer;
+  typedef std::vector <Model::Vector> VectorContainer;
+
+  /**Returns pseudo random value in range [min; max)
+   * Fixed seed makes inputs the same in each run
+   *
+   */
+  float random (float min, float max)
+  {
+    static unsigned int seed = 1;
+
+    seed = seed * 1103515245u + 12345u;
+
+    return min + (max - min) * ( (seed >> 8) & 0xFFFF) / 65536.0f;
+  }
+
+  /**Returns random normalized vector
+   *
+   */
+  Model::Vector randomDirection ()
+  {
+    Model::Vector direction(random(-1, 1), random(-1, 1), random(-1, 1));
+    direction.normalize();
+
+    return direction;
+  }
+
+  /**Creates rays starting around start and going to points around target
+   *
+   */
+  RayContainer createRays (const Model::Point &start,
+                           const Model::Point &target,
+                           float spread)
+  {
+    RayContainer rays(INPUT_COUNT);
+
+    for (Model::Ray &ray : rays)
+    {
+      Model::Point rayStart(start [Model::X] + random(-spread, spread),
+                            start [Model::Y] + random(-spread, spread),
+                            start [Model::Z] + random(-spread, spread));
+      Model::Vector direction(target.diff(rayStart));
+
+      direction.normalize();
+      ray.setParams(rayStart, direction);
+    }
+
+    return rays;
+  }
+
+  /**Runs intersection benchmarks of single object
+   *
+   */
+  void benchmarkIntersections (Benchmark::MicroBenchmark &benchmark,
+                               const QString &name,
+                               const Model::VisibleObject &object,
+                               const RayContainer &rays)
+  {
+    Model::Vector tmpDist;
+
+    benchmark.run(name, "rays", [&] (int i)
+    {
+      Model::worldUnit range = 1000.0f;
+
+      object.checkRay(rays [i & (INPUT_COUNT - 1)], range, tmpDist);
+
+      return range;
+    });
+  }
+
+  void benchmarkSphere (Benchmark::MicroBenchmark &benchmark)
+  {
+    Model::Sphere sphere(10.0f);
+    sphere.setPosition(0, 0, 0);
+
+    //Rays are aimed at the center, so all of them hit
+    benchmarkIntersections(benchmark, "Sphere::checkRay hit", sphere,
+                           createRays(Model::Point(0, 0, -100),
+                                      Model::Point(0, 0, 0), 5.0f));
+
+    benchmarkIntersections(benchmark, "Sphere::checkRay miss", sphere,
+                           createRays(Model::Point(0, 0, -100),
+                                      Model::Point(0, 50, 0), 5.0f));
+
+    benchmarkIntersections(benchmark, "Sphere::checkRay inside", sphere,
+                           createRays(Model::Point(0, 0, 0),
+                                      Model::Point(0, 0, 100), 5.0f));
+  }
+
+  void benchmarkPlane (Benchmark::MicroBenchmark &benchmark)
+  {
+    Model::Vector normal(0, 1, 0);
+    Model::Plane plane;
+
+    normal.length = -10.0f;
+    plane.setNormal(normal);
+
+    benchmarkIntersections(benchmark, "Plane::checkRay hit", plane,
+                           createRays(Model::Point(0, 0, 0),
+                                      Model::Point(0, -100, 100), 5.0f));
+
+    benchmarkIntersections(benchmark, "Plane::checkRay miss", plane,
+                           createRays(Model::Point(0, 0, 0),
+                                      Model::Point(0, 100, 100), 5.0f));
+  }
+
+  void benchmarkLatticeSphere (Benchmark::MicroBenchmark &benchmark)
+  {
+    //10 million spheres
+    Model::LatticeSphere lattice(1.0f, 3.0f, 1000, 1000, 10);
+    lattice.setPosition(0, 0, 0);
+
+    benchmarkIntersections(benchmark, "LatticeSphere::checkRay hit", lattice,
+                           createRays(Model::Point(1500, 1500, -100),
+                                      Model::Point(1600, 1600, 0), 50.0f));
+
+    //Rays go through the gap between rows of spheres and cross whole lattice
+    benchmarkIntersections(benchmark, "LatticeSphere::checkRay gap", lattice,
+                           createRays(Model::Point(-100, 1.5f, 1.5f),
+                                      Model::Point(3100, 1.5f, 1.5f), 0.2f));
+  }
+
+  /**Creates spheres placed randomly in cube
+   *
+   */
+  std::vector <Model::Sphere> createSpheres (int count, float extent)
+  {
+    std::vector <Model::Sphere> spheres;
+
+    spheres.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+      spheres.emplace_back(random(0.5f, 2.0f));
+      spheres.back().setPosition(random(-extent, extent),
+                                 random(-extent, extent),
+                                 random(-extent, extent));
+    }
+
+    return spheres;
+  }
+
+  void benchmarkBVH (Benchmark::MicroBenchmark &benchmark)
+  {
+    std::vector <Model::Sphere> spheres = createSpheres(BVH_SPHERE_COUNT,
+                                                        200.0f);
+    Model::BVH::ObjectContainer objects;
+    Model::BVH bvh;
+
+    for (const Model::Sphere &sphere : spheres)
+    {
+      objects.push_back( &sphere);
+    }
+
+    benchmark.run("BVH::build (10k spheres)", "trees", [&] (int)
+    {
+      bvh.build(objects);
+      return static_cast <float>(bvh.getNodes().size());
+    });
+
+    bvh.build(objects);
+
+    //Spheres move back and forth, so the tree doesn't degrade
+    benchmark.run("BVH::refit (10k moved spheres)", "trees", [&] (int i)
+    {
+      Model::Vector move(0.1f, -0.1f, 0.05f);
+
+      for (Model::Sphere &sphere : spheres)
+      {
+        sphere.setPosition(
+            (i & 1) ? sphere.getPosition() - move : sphere.getPosition() + move);
+      }
+
+      return bvh.refit() ? 1.0f : 0.0f;
+    });
+  }
+
+  /**Runs intersection benchmark of acceleration structure
+   *
+   */
+  void benchmarkAccelerator (Benchmark::MicroBenchmark &benchmark,
+                             const QString &name,
+                             const Model::Accelerator &accelerator,
+                             const RayContainer &rays)
+  {
+    Model::RenderStats stats;
+    Model::Vector tmpDist;
+
+    benchmark.run(name, "rays", [&] (int i)
+    {
+      Model::worldUnit range = 1000.0f;
+      accelerator.findIntersection(rays [i & (INPUT_COUNT - 1)], range,
+                                   tmpDist, stats);
+      return range;
+    });
+  }
+
+  void benchmarkUniformGrid (Benchmark::MicroBenchmark &benchmark)
+  {
+    std::vector <Model::Sphere> spheres = createSpheres(BVH_SPHERE_COUNT,
+                                                        200.0f);
+    Model::Accelerator::ObjectContainer objects;
+    Model::BVH bvh;
+    Model::UniformGrid grid;
+
+    for (const Model::Sphere &sphere : spheres)
+    {
+      objects.push_back( &sphere);
+    }
+
+    benchmark.run("UniformGrid::build (10k spheres)", "grids", [&] (int)
+    {
+      grid.build(objects);
+      return static_cast <float>(grid.getMemoryUsage());
+    });
+
+    bvh.build(objects);
+
+    //Rays start inside the cloud of spheres
+    RayContainer rays = createRays(Model::Point(0, 0, 0),
+                                   Model::Point(0, 0, 300), 150.0f);
+
+    benchmarkAccelerator(benchmark, "BVH::findIntersection (10k spheres)", bvh,
+                         rays);
+    benchmarkAccelerator(benchmark,
+                         "UniformGrid::findIntersection (10k spheres)", grid,
+                         rays);
+  }
+
+  void benchmarkVectors (Benchmark::MicroBenchmark &benchmark)
+  {
+    VectorContainer vectors(INPUT_COUNT);
+    std::vector <Model::SSEData> data(INPUT_COUNT);
+
+    for (int i = 0; i < INPUT_COUNT; ++i)
+    {
+      vectors [i].set(random(-10, 10), random(-10, 10), random(-10, 10));
+      data [i].set(vectors [i] [Model::X], vectors [i] [Model::Y],
+                   vectors [i] [Model::Z]);
+    }
+
+    benchmark.run("SSEData::dotProduct", "ops", [&] (int i)
+    {
+      return vectors [i & (INPUT_COUNT - 1)].dotProduct(
+          vectors [(i + 1) & (INPUT_COUNT - 1)]);
+    });
+
+#if __SSE4_1__ == 1 &&  USE_SSE == 1
+    benchmark.run("SSEData::dotProductDP", "ops", [&] (int i)
+    {
+      return data [i & (INPUT_COUNT - 1)].dotProductDP(
+          data [(i + 1) & (INPUT_COUNT - 1)]);
+    });
+#endif
+
+#if __SSE3__ == 1 &&  USE_SSE == 1
+    benchmark.run("SSEData::dotProductHadd", "ops", [&] (int i)
+    {
+      return data [i & (INPUT_COUNT - 1)].dotProductHadd(
+          data [(i + 1) & (INPUT_COUNT - 1)]);
+    });
+#endif
+
+    benchmark.run("SSEData::dotProductScalar", "ops", [&] (int i)
+    {
+      return data [i & (INPUT_COUNT - 1)].dotProductScalar(
+          data [(i + 1) & (INPUT_COUNT - 1)]);
+    });
+
+    benchmark.run("Vector::normalize", "ops", [&] (int i)
+    {
+      Model::Vector vector(vectors [i & (INPUT_COUNT - 1)]);
+      vector.normalize();
+
+      return vector [Model::X];
+    });
+  }
+
+  void benchmarkColors (Benchmark::MicroBenchmark &benchmark)
+  {
+    std::vector <Model::Color> colors(INPUT_COUNT);
+
+    //Some values are out of range, so saturation is used
+    for (Model::Color &color : colors)
+    {
+      color.setColor(random(0, 300), random(0, 300), random(0, 300));
+    }
+
+    benchmark.run("Color::red/green/blue", "colors", [&] (int i)
+    {
+      const Model::Color &color = colors [i & (INPUT_COUNT - 1)];
+
+      return static_cast <float>(color.red() + color.green() + color.blue());
+    });
+  }
+
+  void benchmarkTexture (Benchmark::MicroBenchmark &benchmark)
+  {
+    QString textureFile = QDir::temp().filePath("benchmark_texture.bmp");
+    QImage image(TEXTURE_SIZE, TEXTURE_SIZE, QImage::Format_RGB32);
+
+    for (int y = 0; y < TEXTURE_SIZE; ++y)
+    {
+      for (int x = 0; x < TEXTURE_SIZE; ++x)
+      {
+        image.setPixel(x, y, qRgb(x, y, x ^ y));
+      }
+    }
+
+    if (!image.save(textureFile))
+    {
+      return;
+    }
+
+    Model::Material material;
+    VectorContainer normals(INPUT_COUNT);
+
+    material.setTexture(textureFile);
+    QFile::remove(textureFile);
+
+    for (Model::Vector &normal : normals)
+    {
+      normal = randomDirection();
+    }
+
+    benchmark.run("Material::getTextureColor", "samples", [&] (int i)
+    {
+      return static_cast <float>(material.getTextureColor(
+          normals [i & (INPUT_COUNT - 1)]).red());
+    });
+
+    benchmark.run("Material::getTextureColor (approximate)", "samples",
+                  [&] (int i)
+                  {
+                    return static_cast <float>(material.getTextureColor(
+                        normals [i & (INPUT_COUNT - 1)], 0.0f, true).red());
+                  });
+  }
+
+  void benchmarkFastMath (Benchmark::MicroBenchmark &benchmark)
+  {
+    std::vector <float> x(INPUT_COUNT), y(INPUT_COUNT), z(INPUT_COUNT);
+
+    for (int i = 0; i < INPUT_COUNT; ++i)
+    {
+      Model::Vector normal = randomDirection();
+
+      x [i] = normal [Model::X];
+      y [i] = normal [Model::Y];
+      z [i] = normal [Model::Z];
+    }
+
+    benchmark.run("libm spherical UV", "normals", [&] (int i)
+    {
+      int idx = i & (INPUT_COUNT - 1);
+
+      return acos(y [idx]) / PI
+          + acos(x [idx] / sin(acos(y [idx]))) / (2 * PI);
+    });
+
+    benchmark.run("FastMath::sphericalUV", "normals", [&] (int i)
+    {
+      int idx = i & (INPUT_COUNT - 1);
+      float u, v;
+
+      Model::FastMath::sphericalUV(Model::Vector(x [idx], y [idx], z [idx]),
+                                   u, v);
+
+      return u + v;
+    });
+
+    benchmark.run("FastMath::packetSphericalUV", "packets", [&] (int i)
+    {
+      int idx = (i * PACKET_SIZE) & (INPUT_COUNT - 1);
+      Model::PacketFloat u, v;
+      alignas(32) float values [PACKET_SIZE];
+
+      Model::FastMath::packetSphericalUV(
+          Model::packetLoadUnaligned( &x [idx]),
+          Model::packetLoadUnaligned( &y [idx]),
+          Model::packetLoadUnaligned( &z [idx]), u, v);
+      Model::packetStore(values, Model::packetAdd(u, v));
+
+      return values [0];
+    });
+  }
+
+  /**Checks errors of approximated math against libm
+   * Packet versions have to give the same results as scalar ones.
+   *
+   * @param out output stream
+   * @return false if any error is out of bounds
+   */
+  bool checkFastMath (QTextStream &out)
+  {
+    double acosError = 0;
+    double atan2Error = 0;
+    double packetError = 0;
+    alignas(32) float args [2] [PACKET_SIZE];
+    alignas(32) float results [2] [PACKET_SIZE];
+
+    for (int i = 0; i <= CHECK_SAMPLE_COUNT; i += PACKET_SIZE)
+    {
+      for (int lane = 0; lane < PACKET_SIZE; ++lane)
+      {
+        //Whole range [-1; 1] with both ends
+        float value = -1.0f + 2.0f * (i + lane) / CHECK_SAMPLE_COUNT;
+        float angle = 2.0f * PI * (i + lane) / CHECK_SAMPLE_COUNT;
+
+        args [0] [lane] = value < 1.0f ? value : 1.0f;
+        args [1] [lane] = angle;
+      }
+
+      Model::PacketFloat sinPacket, cosPacket;
+      alignas(32) float sines [PACKET_SIZE], cosines [PACKET_SIZE];
+
+      for (int lane = 0; lane < PACKET_SIZE; ++lane)
+      {
+        sines [lane] = sin(args [1] [lane]);
+        cosines [lane] = cos(args [1] [lane]);
+      }
+
+      sinPacket = Model::packetLoad(sines);
+      cosPacket = Model::packetLoad(cosines);
+
+      Model::packetStore(results [0], Model::FastMath::packetAcos(
+          Model::packetLoad(args [0])));
+      Model::packetStore(results [1], Model::FastMath::packetAtan2(
+          sinPacket, cosPacket));
+
+      for (int lane = 0; lane < PACKET_SIZE; ++lane)
+      {
+        double value = args [0] [lane];
+        double sine = sines [lane];
+        double cosine = cosines [lane];
+        float fastAcos = Model::FastMath::acos(args [0] [lane]);
+        float fastAtan2 = Model::FastMath::atan2(sines [lane], cosines [lane]);
+
+        acosError = std::max(acosError, std::fabs(fastAcos - std::acos(value)));
+        atan2Error = std::max(atan2Error,
+                              std::fabs(fastAtan2 - std::atan2(sine, cosine)));
+        double acosDiff = std::fabs(results [0] [lane] - fastAcos);
+        double atan2Diff = std::fabs(results [1] [lane] - fastAtan2);
+
+        packetError = std::max(packetError, std::max(acosDiff, atan2Diff));
+      }
+    }
+
+    bool ok = acosError <= FAST_ACOS_MAX_ERROR
+        && atan2Error <= FAST_ATAN2_MAX_ERROR && packetError <= 1e-5;
+
+    out << "FastMath::acos max error:   " << acosError << " (bound "
+        << FAST_ACOS_MAX_ERROR << ")\n"
+        << "FastMath::atan2 max error:  " << atan2Error << " (bound "
+        << FAST_ATAN2_MAX_ERROR << ")\n"
+        << "packet vs scalar max error: " << packetError << " (bound 1e-5)\n"
+        << "Max texel error of " << TEXTURE_SIZE << "x" << TEXTURE_SIZE
+        << " texture: "
+        << std::max(acosError / PI, atan2Error / (2 * PI))
+            * TEXTURE_SIZE << "\n" << (ok ? "OK" : "FAILED") << "\n";
+
+    return ok;
+  }
+
+  /**Checks intersections of lattice against its spheres checked one by one
+   *
+   * @param out output stream
+   * @param radius radius of spheres
+   * @param offset distance between neighbouring centers
+   * @param count amount of spheres on each axis
+   * @return false if any intersection differs
+   */
+  bool checkLatticeSphere (QTextStream &out,
+                           float radius,
+                           float offset,
+                           int count)
+  {
+    Model::LatticeSphere lattice(radius, offset, count, count + 1, count + 2);
+    std::vector <Model::Sphere> spheres;
+    Model::Vector tmpDist;
+    int mismatches = 0;
+
+    lattice.setPosition(-3, 1, 2);
+
+    for (int x = 0; x < count; ++x)
+    {
+      for (int y = 0; y < count + 1; ++y)
+      {
+        for (int z = 0; z < count + 2; ++z)
+        {
+          spheres.emplace_back(radius);
+          spheres.back().setPosition(-3 + x * offset, 1 + y * offset,
+                                     2 + z * offset);
+        }
+      }
+    }
+
+    float extent = count * (offset + radius);
+
+    for (int i = 0; i < CHECK_RAY_COUNT; ++i)
+    {
+      Model::Ray ray(
+          Model::Point(random(-extent, extent), random(-extent, extent),
+                       random(-extent, extent)),
+          randomDirection());
+      Model::worldUnit latticeRange = 1000.0f;
+      Model::worldUnit sphereRange = 1000.0f;
+      bool latticeHit = lattice.checkRay(ray, latticeRange, tmpDist);
+      bool sphereHit = false;
+
+      for (const Model::Sphere &sphere : spheres)
+      {
+        sphereHit |= sphere.checkRay(ray, sphereRange, tmpDist);
+      }
+
+      if (latticeHit != sphereHit
+          || std::fabs(latticeRange - sphereRange) > 1e-3f)
+      {
+        ++mismatches;
+      }
+    }
+
+    out << "LatticeSphere r=" << radius << " offset=" << offset
+        << " mismatches: " << mismatches << "\n";
+
+    return mismatches == 0;
+  }
+
+  /**Checks refitted BVH against BVH built over moved spheres
+   * Spheres are moved a bit first, so the refitted tree should be kept.
+   * Then they are shuffled, so the tree should ask for rebuild.
+   *
+   * @param out output stream
+   * @return false if any intersection differs or degradation isn't found
+   */
+  bool checkBVHRefit (QTextStream &out)
+  {
+    std::vector <Model::Sphere> spheres = createSpheres(BVH_SPHERE_COUNT / 5,
+                                                        50.0f);
+    Model::BVH::ObjectContainer objects;
+    Model::BVH refitted, built;
+    Model::RenderStats stats;
+    Model::Vector tmpDist;
+    int mismatches = 0;
+
+    for (const Model::Sphere &sphere : spheres)
+    {
+      objects.push_back( &sphere);
+    }
+
+    refitted.build(objects);
+
+    for (Model::Sphere &sphere : spheres)
+    {
+      sphere.setPosition(sphere.getPosition() + randomDirection());
+    }
+
+    bool kept = refitted.refit();
+    built.build(objects);
+
+    for (int i = 0; i < CHECK_RAY_COUNT; ++i)
+    {
+      Model::Ray ray(
+          Model::Point(random(-60, 60), random(-60, 60), random(-60, 60)),
+          randomDirection());
+      Model::worldUnit refittedRange = 1000.0f;
+      Model::worldUnit builtRange = 1000.0f;
+
+      if (refitted.findIntersection(ray, refittedRange, tmpDist, stats)
+          != built.findIntersection(ray, builtRange, tmpDist, stats)
+          || refittedRange != builtRange)
+      {
+        ++mismatches;
+      }
+    }
+
+    for (Model::Sphere &sphere : spheres)
+    {
+      sphere.setPosition(random(-50, 50), random(-50, 50), random(-50, 50));
+    }
+
+    bool degraded = !refitted.refit();
+
+    out << "BVH refit mismatches: " << mismatches << ", small move kept tree: "
+        << (kept ? "yes" : "no") << ", shuffle rebuilds tree: "
+        << (degraded ? "yes" : "no") << "\n";
+
+    return mismatches == 0 && kept && degraded;
+  }
+
+  /**Prints usage of program
+   *
+   * @param out output stream
+   */
+  void printUsage (QTextStream &out)
+  {
+    out << "Usage: Benchmark [options]\n"
+        << "  --micro            run kernel benchmarks (default)\n"
+        << "  --scenes           run scene benchmarks\n"
+        << "  --check            check approximated math, lattices and BVH refit\n"
+        << "  --json <file>      write scene results to file instead of stdout\n"
+        << "  --threads <count>  maximal thread count of scene benchmarks\n";
+  }
+
+  /**Renders shipped scene and generated lattices
+   *
+   */
+  int runSceneBenchmark (int maxThreadCount, const QString &jsonFile)
+  {
+    QTextStream log(stderr);
+    Benchmark::SceneBenchmark benchmark(maxThreadCount, SCENE_REPEAT_COUNT);
+    QString smallLattice = QDir::temp().filePath("benchmark_lattice_small.xml");
+    QString bigLattice = QDir::temp().filePath("benchmark_lattice_big.xml");
+
+    if (!Benchmark::SceneBenchmark::generateLattice(smallLattice,
+                                                    SMALL_LATTICE_SIZE)
+        || !Benchmark::SceneBenchmark::generateLattice(bigLattice,
+                                                       BIG_LATTICE_SIZE))
+    {
+      log << "Can't write lattice scenes to " << QDir::tempPath() << "\n";
+      return 1;
+    }
+
+    benchmark.addScene(DEFAULT_SCENE_FILE_NAME, DEFAULT_SCENE_FILE_NAME);
+    benchmark.addScene("lattice10k", smallLattice);
+    benchmark.addScene("lattice100k", bigLattice);
+
+    benchmark.run(log);
+
+    QFile::remove(smallLattice);
+    QFile::remove(bigLattice);
+
+    if (jsonFile.isEmpty())
+    {
+      QTextStream out(stdout);
+      benchmark.writeJson(out);
+      return 0;
+    }
+
+    QFile file(jsonFile);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+      log << "Can't write " << jsonFile << "\n";
+      return 1;
+    }
+
+    QTextStream out( &file);
+    benchmark.writeJson(out);
+
+    return 0;
+  }
+}
+
+int main (int argc, char *argv [])
+{
+  QCoreApplication app(argc, argv);
+  QStringList arguments = app.arguments();
+  QTextStream out(stdout);
+  QTextStream err(stderr);
+  bool micro = false;
+  bool scenes = false;
+  bool check = false;
+  int maxThreadCount = QThread::idealThreadCount();
+  QString jsonFile;
+
+  for (int i = 1; i < arguments.size(); ++i)
+  {
+    bool ok = true;
+
+    if (arguments [i] == "--micro")
+    {
+      micro = true;
+    }
+    else if (arguments [i] == "--scenes")
+    {
+      scenes = true;
+    }
+    else if (arguments [i] == "--check")
+    {
+      check = true;
+    }
+    else if (arguments [i] == "--json" && i + 1 < arguments.size())
+    {
+      jsonFile = arguments [++i];
+    }
+    else if (arguments [i] == "--threads" && i + 1 < arguments.size())
+    {
+      maxThreadCount = arguments [++i].toInt( &ok);
+      ok = ok && maxThreadCount > 0;
+    }
+    else
+    {
+      ok = false;
+    }
+
+    if (!ok)
+    {
+      printUsage(err);
+      return 1;
+    }
+  }
+
+  //Lattices with separated, touching and overlapping spheres
+  if (check
+      && (!checkFastMath(out) || !checkLatticeSphere(out, 1.0f, 3.0f, 6)
+          || !checkLatticeSphere(out, 1.0f, 2.0f, 6)
+          || !checkLatticeSphere(out, 1.5f, 1.0f, 5) || !checkBVHRefit(out)))
+  {
+    return 1;
+  }
+
+  if (!micro && !scenes && !check)
+  {
+    micro = true;
+  }
+
+  if (micro)
+  {
+    Benchmark::MicroBenchmark benchmark(MIN_BENCHMARK_TIME);
+
+    benchmarkSphere(benchmark);
+    benchmarkPlane(benchmark);
+    benchmarkLatticeSphere(benchmark);
+    benchmarkBVH(benchmark);
+    benchmarkUniformGrid(benchmark);
+    benchmarkVectors(benchmark);
+    benchmarkColors(benchmark);
+    benchmarkTexture(benchmark);
+    benchmarkFastMath(benchmark);
+
+    //Scene results go to stdout, so table is moved out of the way
+    benchmark.print(scenes && jsonFile.isEmpty() ? err : out);
+  }
+
+  if (scenes)
+  {
+    return runSceneBenchmark(maxThreadCount, jsonFile);
+  }
+
+  return 0;
+}
@@ -0,0 +1,7 @@
+set(HDRS_Batch
+  ${SOURCE_DIR}/Batch/BatchRunner.h
+)
+set(SRCS_Batch
+  ${SOURCE_DIR}/Batch/BatchRunner.cpp
+  ${SOURCE_DIR}/Batch/main.cpp
+)
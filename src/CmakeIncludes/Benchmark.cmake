@@ -0,0 +1,9 @@
+set(HDRS_Benchmark
+  ${SOURCE_DIR}/Benchmark/MicroBenchmark.h
+  ${SOURCE_DIR}/Benchmark/SceneBenchmark.h
+)
+set(SRCS_Benchmark
+  ${SOURCE_DIR}/Benchmark/MicroBenchmark.cpp
+  ${SOURCE_DIR}/Benchmark/SceneBenchmark.cpp
+  ${SOURCE_DIR}/Benchmark/main.cpp
+)
@@ -35,6 +35,11 @@ if(CMAKE_COMPILER_IS_GNUCC)
     add_definitions(-O3)
   endif()
 
+  # Render counters (Model/RenderStats.h) are compiled out in Release.
+  if(NOT CMAKE_BUILD_TYPE STREQUAL ${Release})
+    add_definitions(-D RENDER_STATS)
+  endif()
+
   if(PLATFORM_TARGET STREQUAL ${x86})
     add_definitions(-m32)
     set (CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -m32")
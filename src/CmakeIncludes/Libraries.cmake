@@ -1,5 +1,5 @@
 #for all systems
-find_package (Qt4 REQUIRED QtCore QtGui QtXml)
+find_package (Qt4 REQUIRED QtCore QtGui)
 
 include(${QT_USE_FILE})
 ADD_DEFINITIONS(${QT_DEFINITIONS})
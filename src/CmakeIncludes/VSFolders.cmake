@@ -1,45 +1,93 @@
 
 # Model.
 SOURCE_GROUP("Header Files" FILES
+  ${SOURCE_DIR}/Model/Accelerator.h
+  ${SOURCE_DIR}/Model/BVH.h
+  ${SOURCE_DIR}/Model/BoundingBox.h
   ${SOURCE_DIR}/Model/Camera.h
   ${SOURCE_DIR}/Model/Color.h
+  ${SOURCE_DIR}/Model/CompiledSceneFile.h
+  ${SOURCE_DIR}/Model/FastMath.h
+  ${SOURCE_DIR}/Model/GroupInstance.h
+  ${SOURCE_DIR}/Model/LatticeSphere.h
   ${SOURCE_DIR}/Model/Light.h
   ${SOURCE_DIR}/Model/Material.h
   ${SOURCE_DIR}/Model/ModelDefines.h
   ${SOURCE_DIR}/Model/Object.h
+  ${SOURCE_DIR}/Model/ObjectGroup.h
   ${SOURCE_DIR}/Model/Plane.h
   ${SOURCE_DIR}/Model/Point.h
   ${SOURCE_DIR}/Model/Point2D.h
   ${SOURCE_DIR}/Model/Ray.h
+  ${SOURCE_DIR}/Model/RayPacket.h
+  ${SOURCE_DIR}/Model/RenderStats.h
   ${SOURCE_DIR}/Model/RenderTileData.h
   ${SOURCE_DIR}/Model/Renderer.h
+  ${SOURCE_DIR}/Model/ReprojectionCache.h
   ${SOURCE_DIR}/Model/SSEData.h
   ${SOURCE_DIR}/Model/Scene.h
   ${SOURCE_DIR}/Model/SceneFileManager.h
   ${SOURCE_DIR}/Model/Sphere.h
+  ${SOURCE_DIR}/Model/SphereStore.h
+  ${SOURCE_DIR}/Model/Texture.h
+  ${SOURCE_DIR}/Model/TextureCache.h
+  ${SOURCE_DIR}/Model/UniformGrid.h
   ${SOURCE_DIR}/Model/Vector.h
   ${SOURCE_DIR}/Model/VisibleObject.h
 )
 SOURCE_GROUP("Source Files" FILES
+  ${SOURCE_DIR}/Model/BVH.cpp
   ${SOURCE_DIR}/Model/Camera.cpp
+  ${SOURCE_DIR}/Model/CompiledSceneFile.cpp
+  ${SOURCE_DIR}/Model/GroupInstance.cpp
+  ${SOURCE_DIR}/Model/LatticeSphere.cpp
   ${SOURCE_DIR}/Model/Object.cpp
+  ${SOURCE_DIR}/Model/ObjectGroup.cpp
   ${SOURCE_DIR}/Model/Plane.cpp
   ${SOURCE_DIR}/Model/Renderer.cpp
+  ${SOURCE_DIR}/Model/ReprojectionCache.cpp
   ${SOURCE_DIR}/Model/Scene.cpp
   ${SOURCE_DIR}/Model/SceneFileManager.cpp
   ${SOURCE_DIR}/Model/Sphere.cpp
+  ${SOURCE_DIR}/Model/SphereStore.cpp
+  ${SOURCE_DIR}/Model/Texture.cpp
+  ${SOURCE_DIR}/Model/TextureCache.cpp
+  ${SOURCE_DIR}/Model/UniformGrid.cpp
 )
 
 # Controller.
 SOURCE_GROUP("Header Files" FILES
   ${SOURCE_DIR}/Controller/GlobalDefines.h
   ${SOURCE_DIR}/Controller/MainWindow.h
+  ${SOURCE_DIR}/Controller/RenderParams.h
   ${SOURCE_DIR}/Controller/RendererThread.h
   ${SOURCE_DIR}/Controller/ThreadRunner.h
+  ${SOURCE_DIR}/Controller/TileScheduler.h
 )
 SOURCE_GROUP("Source Files" FILES
   ${SOURCE_DIR}/Controller/MainWindow.cpp
   ${SOURCE_DIR}/Controller/RendererThread.cpp
   ${SOURCE_DIR}/Controller/ThreadRunner.cpp
+  ${SOURCE_DIR}/Controller/TileScheduler.cpp
   ${SOURCE_DIR}/Controller/main.cpp
 )
+
+# Batch.
+SOURCE_GROUP("Header Files" FILES
+  ${SOURCE_DIR}/Batch/BatchRunner.h
+)
+SOURCE_GROUP("Source Files" FILES
+  ${SOURCE_DIR}/Batch/BatchRunner.cpp
+  ${SOURCE_DIR}/Batch/main.cpp
+)
+
+# Benchmark.
+SOURCE_GROUP("Header Files" FILES
+  ${SOURCE_DIR}/Benchmark/MicroBenchmark.h
+  ${SOURCE_DIR}/Benchmark/SceneBenchmark.h
+)
+SOURCE_GROUP("Source Files" FILES
+  ${SOURCE_DIR}/Benchmark/MicroBenchmark.cpp
+  ${SOURCE_DIR}/Benchmark/SceneBenchmark.cpp
+  ${SOURCE_DIR}/Benchmark/main.cpp
+)
@@ -17,15 +17,24 @@
 #include "Controller/MainWindow.h"
 #include "Controller/RendererThread.h"
 #include "Controller/ThreadRunner.h"
+#include "Model/RenderStats.h"
 #include "Model/RenderTileData.h"
+#include "Model/ReprojectionCache.h"
 #include "Model/Scene.h"
 #include "View/ui_MainWindow.h"
 
 #define TIME_BEFORE_REMOVE_THREADS 1000 //[ms]
 #define DEFAULT_REFRESH_TIME 1000 //[ms]
+#define PREVIEW_PIXEL_STEP 8 //First pass of progressive preview [px]
 #define WINDOW_MARGIN 0
 #define IMAGE_SAVE_FORMAT "png"
 
+//Progressive preview isn't used when this part of pixels is reprojected
+#define PREVIEW_MAX_REPROJECTED 0.5f
+
+//First column of render counters in result list
+#define RESULT_LIST_STATS_COLUMN 7
+
 #define DEFAULT_IMAGE_WIDTH 800
 #define DEFAULT_IMAGE_HEIGHT 600
 #define DEFAULT_TILE_SIZE 100
@@ -52,6 +61,18 @@ namespace Controller
       }
   };
 
+  class MainWindow::PreviewInProgressState: public MainWindow::MainWindowState
+  {
+    public:
+      virtual void Activate (MainWindow &window)
+      {
+        window.deactivateButtons(true);
+
+        //Camera changes restart preview
+        window.ui->cameraGroup->setDisabled(false);
+      }
+  };
+
   class MainWindow::ReadyForRenderingState: public MainWindow::MainWindowState
   {
     public:
@@ -83,7 +104,8 @@ namespace Controller
   MainWindow::MainWindow (QMainWindow *myParent)
       : QMainWindow(myParent), image(new Model::RenderTileData), scene(
           new Model::Scene), timeCounter(new QElapsedTimer), renderParams(
-          new RenderParams), threadRunner(new ThreadRunner)
+          new RenderParams), threadRunner(new ThreadRunner), reprojectionCache(
+          new Model::ReprojectionCache)
   {
     ui.reset(new Ui::MainWindow);
     refreshTimer.reset(new QTimer);
@@ -92,7 +114,8 @@ namespace Controller
     image->imageData = 0;
 
     renderParams->scene = scene;
-    renderParams->randomRender = false;
+    renderParams->pixelStep = 1;
+    renderParams->previousPixelStep = 0;
 
     threadRunner->setParams(image, renderParams);
     threadRunner->setAutoDelete(false);
@@ -100,9 +123,12 @@ namespace Controller
     sizeChanged = false;
     addResult = true;
     renderingInProgress = false;
+    previewRestart = false;
+    reprojectionOutdated = false;
 
     states.resize(StatesCount);
     states [RenderingInProgress].reset(new RenderingInProgressState);
+    states [PreviewInProgress].reset(new PreviewInProgressState);
     states [ReadyForRendering].reset(new ReadyForRenderingState);
     states [WaitingForSceneFile].reset(new WaitingForSceneFileState);
 
@@ -123,15 +149,43 @@ namespace Controller
 
   void MainWindow::runRenderer ()
   {
+    //Live camera preview is refined from coarse blocks to full resolution
+    bool progressive = ui->liveCamera->isChecked()
+        && ui->progressivePreview->isChecked();
+    //Anti-aliased edges are shaded from neighbours, not from cache
+    bool reprojection = ui->liveCamera->isChecked()
+        && ui->reprojection->isChecked() && !ui->analyticAA->isChecked()
+        && ui->adaptiveAA->currentIndex() == 0;
+
     renderingInProgress = true;
+    previewRestart = false;
 
-    setState(RenderingInProgress);
+    setState(progressive ? PreviewInProgress : RenderingInProgress);
 
     if (!updateCamera())
     {
       return;
     }
 
+    if (reprojectionOutdated)
+    {
+      reprojectionCache->clear();
+      reprojectionOutdated = false;
+    }
+
+    //Pixels of previous frames are moved to the new view
+    if (reprojection)
+    {
+      size_t reprojectedCount = reprojectionCache->reproject(
+          scene->getCamera());
+
+      //Coarse passes wouldn't be faster than mostly reused frame
+      progressive = progressive
+          && reprojectedCount
+              < PREVIEW_MAX_REPROJECTED * image->imageWidth
+                  * image->imageHeight;
+    }
+
     if (!ui->liveCamera->isChecked())
     {
       ui->imageViewer->getImage()->fill(Qt::darkGray);
@@ -143,17 +197,28 @@ namespace Controller
     renderParams->reflectionDeep = ui->maxReflectionDeep->value();
     renderParams->refractionDeep = ui->maxRefractionDeep->value();
     renderParams->shadows = ui->shadows->isChecked();
-    renderParams->randomRender = ui->randomRender->isChecked();
+    renderParams->approximateMath = ui->approximateMath->isChecked();
+    renderParams->analyticAA = ui->analyticAA->isChecked();
+
+    //Items are grids of 1x1, 2x2, 3x3 and 4x4 samples
+    int aaGridSize = ui->adaptiveAA->currentIndex() + 1;
+    renderParams->adaptiveAASamples = aaGridSize * aaGridSize;
+    renderParams->adaptiveAAThreshold = ui->adaptiveAAThreshold->value();
+    renderParams->pixelStep = progressive ? PREVIEW_PIXEL_STEP : 1;
+    renderParams->previousPixelStep = 0;
 
-    if (renderParams->randomRender)
+    if (reprojection)
     {
-      threadRunner->randomizeTiles();
+      renderParams->reprojectionCache = reprojectionCache;
     }
     else
     {
-      threadRunner->resetTilesOrder();
+      renderParams->reprojectionCache.reset();
     }
 
+    threadRunner->setTilesOrder(
+        static_cast <TileScheduler::Order>(ui->tileOrder->currentIndex()));
+
     refreshTimer->start();
     timeCounter->start();
 
@@ -177,6 +242,7 @@ namespace Controller
 
       scene->setImageWidth(image->imageWidth);
       scene->setImageHeight(image->imageHeight);
+      reprojectionCache->resize(image->imageWidth, image->imageHeight);
 
       //Create image for image viewer
       ui->imageViewer->setImage(
@@ -214,6 +280,12 @@ namespace Controller
     renderParams->allowRunning = false;
   }
 
+  void MainWindow::invalidateReprojection ()
+  {
+    //Cache is used by workers, so it's cleared before the next render
+    reprojectionOutdated = true;
+  }
+
   void MainWindow::setRefreshTime (int refreshTime)
   {
     refreshTimer->setInterval(refreshTime);
@@ -360,6 +432,16 @@ namespace Controller
 
     ui->resultList->horizontalHeader()->setResizeMode(
         QHeaderView::ResizeToContents);
+
+    //Render counters are compiled out in Release build
+    if (!Model::RenderStats::isEnabled())
+    {
+      for (int i = RESULT_LIST_STATS_COLUMN;
+          i < ui->resultList->columnCount(); ++i)
+      {
+        ui->resultList->setColumnHidden(i, true);
+      }
+    }
     QErrorMessage::qtHandler()->setMinimumSize(200, 100);
 
     setRefreshTime(ui->refreshTime->value());
@@ -380,6 +462,16 @@ namespace Controller
             SLOT(terminateRender()));
     connect(ui->actionSave, SIGNAL(triggered()), this, SLOT(saveImage()));
 
+    //Reprojected colors are shaded with previous settings
+    connect(ui->maxReflectionDeep, SIGNAL(valueChanged(int)), this,
+            SLOT(invalidateReprojection()));
+    connect(ui->maxRefractionDeep, SIGNAL(valueChanged(int)), this,
+            SLOT(invalidateReprojection()));
+    connect(ui->shadows, SIGNAL(toggled(bool)), this,
+            SLOT(invalidateReprojection()));
+    connect(ui->approximateMath, SIGNAL(toggled(bool)), this,
+            SLOT(invalidateReprojection()));
+
     //Camera movement
     connect(ui->forward, SIGNAL(clicked()), this, SLOT(moveCamera()));
     connect(ui->backward, SIGNAL(clicked()), this, SLOT(moveCamera()));
@@ -481,6 +573,11 @@ namespace Controller
 
   void MainWindow::renderFinished ()
   {
+    if (continuePreview())
+    {
+      return;
+    }
+
     qint64 elapsedTime = timeCounter->elapsed();
     refreshTimer->stop();
 
@@ -492,6 +589,43 @@ namespace Controller
     renderingInProgress = false;
   }
 
+  bool MainWindow::continuePreview ()
+  {
+    if (previewRestart)
+    {
+      runRenderer();
+      return true;
+    }
+
+    //Terminated preview isn't refined
+    if (renderParams->pixelStep > 1 && renderParams->allowRunning)
+    {
+      renderParams->previousPixelStep = renderParams->pixelStep;
+      renderParams->pixelStep /= 2;
+
+      updateImage();
+      QThreadPool::globalInstance()->start(threadRunner.data());
+
+      return true;
+    }
+
+    return false;
+  }
+
+  void MainWindow::stopPreview ()
+  {
+    if (_currentState != PreviewInProgress)
+    {
+      return;
+    }
+
+    previewRestart = true;
+    renderParams->allowRunning = false;
+
+    //Workers stop at the next scanline
+    QThreadPool::globalInstance()->waitForDone();
+  }
+
   void MainWindow::loadScene ()
   {
     bool result = false;
@@ -502,7 +636,7 @@ namespace Controller
       fileName = QFileDialog::getOpenFileName(this,
                                               QSTRING("Otwórz plik sceny"),
                                               QSTRING(DEFAULT_SCENE_FILE_NAME),
-                                              tr("XML files (*.xml)"), 0,
+                                              tr("Scene files (*.xml *.rtscene)"), 0,
                                               QFileDialog::DontUseNativeDialog);
     }
 
@@ -535,6 +669,9 @@ namespace Controller
     scene->updateCamera();
     setState(ReadyForRendering);
 
+    //Samples point to objects of previous scene
+    invalidateReprojection();
+
     //Preserve camera settings
     if (ui->keepCameraSettings->isChecked())
     {
@@ -589,6 +726,23 @@ namespace Controller
     items [col++ ]->setData(0, QVariant(time));  //Render time
     items [col++ ]->setData(0, QVariant(image->imageWidth));  //Image width
     items [col++ ]->setData(0, QVariant(image->imageHeight));  //Image height
+
+    if (Model::RenderStats::isEnabled())
+    {
+      Model::RenderStats stats = threadRunner->getStats();
+
+      items [col++ ]->setData(0, QVariant(stats.primaryRays));
+      items [col++ ]->setData(0, QVariant(stats.reflectionRays));
+      items [col++ ]->setData(0, QVariant(stats.refractionRays));
+      items [col++ ]->setData(0, QVariant(stats.shadowRays));
+      items [col++ ]->setData(0, QVariant(stats.getIntersectionTestsPerRay()));
+      items [col++ ]->setData(0, QVariant(stats.earlyTerminations));
+      items [col++ ]->setData(0, QVariant(stats.totalInternalReflections));
+      items [col++ ]->setData(0, QVariant(stats.textureLookups));
+      items [col++ ]->setData(
+          0, QVariant(stats.accelerationBuildTime / static_cast <double>(MEGA)));
+      items [col++ ]->setData(0, QVariant(stats.accelerationMemory / 1024));
+    }
     delete [] items;
 
     ui->resultList->sortByColumn(0, Qt::AscendingOrder);
@@ -601,6 +755,8 @@ namespace Controller
 
     float speed = ui->movementSpeed->value();
 
+    stopPreview();
+
     //[1] because [0] == & -> shortcut
     switch (button->text() [1].toAscii())
     {
@@ -638,6 +794,8 @@ namespace Controller
 
     float speed = ui->rotateAngle->value();
 
+    stopPreview();
+
     //[1] because [0] == & -> shortcut
     switch (button->text() [1].toAscii())
     {
@@ -20,6 +20,7 @@ namespace Ui
 namespace Model
 {
   struct RenderTileData;
+  class ReprojectionCache;
   class Scene;
 }
 // <-- Forward declarations
@@ -106,6 +107,12 @@ namespace Controller
        */
       void setRefreshTime (int refreshTime);
 
+      /**Listener for changes of shading settings
+       * Colors of previous frames can't be reused after them.
+       *
+       */
+      void invalidateReprojection ();
+
       /**Listener for update image events
        * It updates image in the main window
        *
@@ -131,12 +138,14 @@ namespace Controller
     private:
       class MainWindowState;
       class RenderingInProgressState;
+      class PreviewInProgressState;
       class ReadyForRenderingState;
       class WaitingForSceneFileState;
 
       enum States
       {
           RenderingInProgress,
+          PreviewInProgress,
           ReadyForRendering,
           WaitingForSceneFile,
           StatesCount
@@ -167,6 +176,12 @@ namespace Controller
        */
       bool renderingInProgress;
 
+      /**Camera was changed during progressive preview, so preview starts
+       * again when the current pass stops
+       *
+       */
+      bool previewRestart;
+
       /**Stores 3D scene
        *
        */
@@ -197,11 +212,36 @@ namespace Controller
        */
       QScopedPointer <ThreadRunner> threadRunner;
 
+      /**Hits and colors of previous frames of live camera
+       *
+       */
+      std::shared_ptr <Model::ReprojectionCache> reprojectionCache;
+
+      /**Scene or shading settings were changed, so cache is cleared
+       * before the next render
+       *
+       */
+      bool reprojectionOutdated;
+
       States _currentState;
       std::vector <std::unique_ptr <MainWindowState>> states;
 
       void setState(States state);
 
+      /**Starts next pass of progressive preview
+       * Preview starts again if camera was changed.
+       *
+       * @return false if there is no pass left
+       */
+      bool continuePreview ();
+
+      /**Stops progressive preview before camera is changed
+       * Workers read camera, so it waits until they stop. Preview
+       * starts again when it's finished.
+       *
+       */
+      void stopPreview ();
+
       /**Activates buttons in GUI.
        * Sets state to rendering ready.
        * It enables:
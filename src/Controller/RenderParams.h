@@ -0,0 +1,69 @@
+/// @file Controller/RenderParams.h
+
+#pragma once
+
+#include <atomic>
+
+#include "Model/ModelDefines.h"
+
+//Forward declarations -->
+namespace Model
+{
+  class ReprojectionCache;
+}
+// <-- Forward declarations
+
+namespace Controller
+{
+
+  /**Rendering parameters shared by all render workers
+   *
+   */
+  struct RenderParams
+  {
+      Model::SceneSharedPtr scene;
+      /**Workers stop when it's cleared
+       * It's checked once per scanline with relaxed loads
+       *
+       */
+      std::atomic <bool> allowRunning;
+      bool shadows;
+      /**Texture mapping uses FastMath approximations instead of libm
+       *
+       */
+      bool approximateMath;
+      /**Edges of spheres and planes are smoothed with analytic coverage
+       *
+       */
+      bool analyticAA;
+      /**Samples of pixels on edges; 1 disables adaptive anti-aliasing
+       * Samples are placed on square grid, so it should be 4, 9, 16...
+       * It's used instead of analytic anti-aliasing when both are set.
+       *
+       */
+      int adaptiveAASamples;
+      /**Difference of color component of neighbouring pixels which makes
+       * them edge pixels [0, COLOR_MAX_VALUE]
+       *
+       */
+      int adaptiveAAThreshold;
+      /**Size of blocks of pixels filled by one ray; 1 renders every pixel
+       *
+       */
+      int pixelStep;
+      /**Pixel step of previous pass of progressive preview; 0 if there
+       * wasn't any
+       *
+       */
+      int previousPixelStep;
+      /**Colors of previous frames reused after camera moves; nullptr if
+       * every pixel is shaded
+       *
+       */
+      std::shared_ptr <Model::ReprojectionCache> reprojectionCache;
+      int maxThreadCount;
+      int reflectionDeep;
+      int refractionDeep;
+  };
+
+} /* namespace Controller */
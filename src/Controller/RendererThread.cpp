@@ -1,14 +1,20 @@
 /// @file Controller/RendererThread.cpp
 
+#include <QElapsedTimer>
+
 #include "Controller/RendererThread.h"
+#include "Controller/TileScheduler.h"
 #include "Model/Renderer.h"
 #include "Model/RenderTileData.h"
 
 namespace Controller
 {
 
-  RendererThread::RendererThread (const std::shared_ptr <RenderParams> &newRenderParams)
-      : renderer(new Model::Renderer(*newRenderParams))
+  RendererThread::RendererThread (const std::shared_ptr <RenderParams> &newRenderParams,
+                                  TileScheduler *newScheduler,
+                                  int newWorkerIdx)
+      : scheduler(newScheduler), workerIdx(newWorkerIdx), renderParams(
+          newRenderParams), renderer(new Model::Renderer(*newRenderParams))
   {
   }
 
@@ -16,9 +22,31 @@ namespace Controller
   {
   }
 
+  const Model::RenderStats &RendererThread::getStats () const
+  {
+    return renderer->getStats();
+  }
+
+  void RendererThread::resetStats ()
+  {
+    renderer->resetStats();
+  }
+
   void RendererThread::run ()
   {
-    renderer->render(*tile);
+    std::shared_ptr <Model::RenderTileData> tile;
+    int tileIdx;
+    QElapsedTimer timer;
+
+    while (renderParams->allowRunning.load(std::memory_order_relaxed)
+        && scheduler->takeTile(tile, tileIdx))
+    {
+      timer.start();
+      renderer->render(*tile);
+
+      //Measured cost is used to order tiles in next frame
+      scheduler->addCost(workerIdx, tileIdx, timer.nsecsElapsed());
+    }
   }
 
 } /* namespace Controller */
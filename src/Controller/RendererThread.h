@@ -4,66 +4,74 @@
 
 #include <QScopedPointer>
 
-#include <QObject>
 #include <QRunnable>
 
+#include "Controller/RenderParams.h"
 #include "Model/ModelDefines.h"
+#include "Model/RenderStats.h"
 
 namespace Controller
 {
+  //Forward declarations -->
+  class TileScheduler;
+  // <-- Forward declarations
 
-  struct RenderParams
-  {
-      Model::SceneSharedPtr scene;
-      bool allowRunning;
-      bool randomRender;
-      bool shadows;
-      int maxThreadCount;
-      int reflectionDeep;
-      int refractionDeep;
-  };
-
-  /**Single render thread
-   * It renders part of image which is described in tile parameter
+  /**Single render worker
+   * It renders tiles taken from tile scheduler until there are no tiles
+   * left. Worker and its renderer are reused between frames.
    *
    */
-  class RendererThread: public QObject, public QRunnable
+  class RendererThread: public QRunnable
   {
-    Q_OBJECT
-
     public:
 
       /**Initializes renderer
        *
+       * @param renderParams rendering parameters
+       * @param newScheduler source of tiles
+       * @param newWorkerIdx index of worker, it selects its cost counters
        */
-      RendererThread (const std::shared_ptr <RenderParams> &renderParams);
+      RendererThread (const std::shared_ptr <RenderParams> &renderParams,
+                      TileScheduler *newScheduler,
+                      int newWorkerIdx);
 
       /**Needed for QScopedPointer
        *
        */
       ~RendererThread ();
 
-      /**Sets tile to render
-       *
-       * @param newTile description of image part to render
-       */
-      void setTile (const std::shared_ptr <Model::RenderTileData> &newTile)
-      {
-        tile = newTile;
-      }
-
-    public slots:
       /**Runs rendering
        * It's called by thread manager
        *
        */
       void run ();
 
+      /**Returns counters of rays traced since last reset
+       *
+       * @return ray counters
+       */
+      const Model::RenderStats &getStats () const;
+
+      /**Sets ray counters to 0
+       *
+       */
+      void resetStats ();
+
     private:
-      /**Description of image part to render
+      /**Source of tiles to render
+       *
+       */
+      TileScheduler *scheduler;
+
+      /**Index of worker cost counters in scheduler
+       *
+       */
+      int workerIdx;
+
+      /**Stores rendering parameters
        *
        */
-      std::shared_ptr <Model::RenderTileData> tile;
+      std::shared_ptr <RenderParams> renderParams;
 
       /**Renderer
        *
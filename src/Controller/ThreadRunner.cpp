@@ -1,6 +1,5 @@
 /// @file Controller/ThreadRunner.cpp
 
-#include <ctime>
 #include <QMutexLocker>
 #include <QThreadPool>
 
@@ -8,19 +7,22 @@
 #include "Controller/MainWindow.h"
 #include "Controller/RendererThread.h"
 #include "Controller/ThreadRunner.h"
+#include "Controller/TileScheduler.h"
 #include "Model/RenderTileData.h"
+#include "Model/Scene.h"
 
-#define THREAD_EXPIRE_TIMEOUT 5
+//Workers are kept alive between frames
+#define THREAD_EXPIRE_TIMEOUT -1
 
 namespace Controller
 {
 
   ThreadRunner::ThreadRunner ()
       : renderParams(new RenderParams), threadPool(new QThreadPool), mutex(
-          new QMutex)
+          new QMutex), scheduler(new TileScheduler)
   {
     threadPool->setExpiryTimeout(THREAD_EXPIRE_TIMEOUT);
-    tilesRandomized = false;
+    tilesOrder = TileScheduler::CostOrder;
   }
 
   ThreadRunner::~ThreadRunner ()
@@ -35,6 +37,9 @@ namespace Controller
     this->image = newImage;
 
     renderParams = newRenderParams;
+
+    //Workers keep pointer to old parameters
+    renderers.clear();
   }
 
   void ThreadRunner::run ()
@@ -42,153 +47,82 @@ namespace Controller
     QMutexLocker locker(mutex.data());
     threadPool->setMaxThreadCount(renderParams->maxThreadCount);
 
-    int tileCount = tiles.size();
-    for (int i = 0; i < tileCount; ++i)
+    updateWorkers(renderParams->maxThreadCount);
+    scheduler->distribute(tilesOrdered, renderers.size(),
+                          tilesOrder == TileScheduler::CostOrder);
+
+    int workerCount = renderers.size();
+    for (int i = 0; i < workerCount; ++i)
     {
+      renderers [i]->resetStats();
       threadPool->start(renderers [i].get());
     }
 
     threadPool->waitForDone();
 
+    //Each worker counted its own rays, they are summed once per frame
+    stats.reset();
+    for (int i = 0; i < workerCount; ++i)
+    {
+      stats += renderers [i]->getStats();
+    }
+
+    stats.accelerationBuildTime =
+        renderParams->scene->getAccelerationBuildTime();
+    stats.accelerationMemory =
+        renderParams->scene->getAccelerationStructure().getMemoryUsage();
+
     emit renderFinished();
   }
 
-  inline void ThreadRunner::createTile (int x,
-                                        int y,
-                                        int tileSizeX,
-                                        int tileSizeY)
+  Model::RenderStats ThreadRunner::getStats () const
   {
-    //Copy common data that are needed to render
-    std::shared_ptr <Model::RenderTileData> tile(
-        new Model::RenderTileData(*image));
-
-    tile->deleteImageData = false;
-
-    tile->topLeft.x = x;
-    tile->topLeft.y = y;
-    tile->bottomRight.x = tile->topLeft.x + tileSizeX;
-    tile->bottomRight.y = tile->topLeft.y + tileSizeY;
-
-    tile->width = tileSizeX;
-    tile->height = tileSizeY;
+    QMutexLocker locker(mutex.data());
 
-    tiles.append(tile);
+    return stats;
   }
 
   void ThreadRunner::createTiles ()
   {
     QMutexLocker locker(mutex.data());
-    tiles.clear();
-
-    imageUnit tileSize = image->width;
-    div_t tilesX = div(image->imageWidth, tileSize);
-    div_t tilesY = div(image->imageHeight, tileSize);
-    imageUnit tileXLimit = image->imageWidth - tilesX.rem;
-    imageUnit tileYLimit = image->imageHeight - tilesY.rem;
-    int tilesNumber = tilesX.quot * tilesY.quot;
-
-    tilesNumber += tilesX.rem > 0 ? 1 : 0;
-    tilesNumber += tilesY.rem > 0 ? 1 : 0;
-
-    tiles.reserve(tilesNumber);
-
-    //Slice image into whole tiles
-    for (imageUnit y = 0; y < tileYLimit; y += tileSize)
-    {
-      for (imageUnit x = 0; x < tileXLimit; x += tileSize)
-      {
-        createTile(x, y, tileSize, tileSize);
-      }
-    }
+    tiles = TileScheduler::createTiles(*image);
+    tilesOrdered = TileScheduler::orderTiles(tiles, tilesOrder);
+  }
 
-    //Slice bottom part of image (if any) into part tiles
-    if (tilesY.rem > 0)
+  void ThreadRunner::updateWorkers (int workerCount)
+  {
+    if (workerCount < 1)
     {
-      for (imageUnit x = 0; x < tileXLimit; x += tileSize)
-      {
-        createTile(x, tileYLimit, tileSize, tilesY.rem);
-      }
+      workerCount = 1;
     }
 
-    //Slice right part of image (if any) into part tiles
-    if (tilesX.rem > 0)
+    while (renderers.size() > workerCount)
     {
-      for (imageUnit y = 0; y < tileYLimit; y += tileSize)
-      {
-        createTile(tileXLimit, y, tilesX.rem, tileSize);
-      }
+      renderers.removeLast();
     }
 
-    //Create tile for right bottom corner if left
-    if (tilesX.rem > 0 && tilesY.rem > 0)
+    while (renderers.size() < workerCount)
     {
-      createTile(tileXLimit, tileYLimit, tilesX.rem, tilesY.rem);
-    }
-
-    renderers.reserve(tiles.size());
-    renderersRandomized.reserve(tiles.size());
-
-    int i = renderers.size() - tiles.size();
+      std::shared_ptr <RendererThread> renderer(
+          new RendererThread(renderParams, scheduler.data(),
+                             renderers.size()));
+      renderer->setAutoDelete(false);
 
-    if (i < 0)
-    { //Create threads if there are more tiles
-      do
-      {
-        std::shared_ptr <RendererThread> renderer(
-            (new RendererThread(renderParams)));
-        renderer->setAutoDelete(false);
-
-        renderers.append(renderer);
-      }
-      while ( ++i < 0);
-    }
-    else
-    { //Delete threads, if there are more than tiles
-      while (i-- > 0)
-      {
-        renderers.removeLast();
-      }
-    }
-    //force assigning tiles to threads
-    tilesRandomized = true;
-    resetTilesOrder();
-  }
-
-  void ThreadRunner::randomizeTiles ()
-  {
-    qsrand(time(NULL));
-    int rand;
-    while (!renderers.empty())
-    {
-      rand = qrand() % renderers.size();
-      renderersRandomized.append(renderers [rand]);
-      renderers.removeAt(rand);
+      renderers.append(renderer);
     }
-    //Do fast swap of vectors
-    renderers.swap(renderersRandomized);
-    tilesRandomized = true;
   }
 
-  void ThreadRunner::resetTilesOrder ()
+  void ThreadRunner::setTilesOrder (TileScheduler::Order order)
   {
-    if (!tilesRandomized)
-    {
-      return;
-    }
-
-    int tileCount = tiles.size();
-    for (int i = 0; i < tileCount; ++i)
-    {
-      renderers [i]->setTile(tiles [i]);
-    }
-    tilesRandomized = false;
+    QMutexLocker locker(mutex.data());
+    tilesOrder = order;
+    tilesOrdered = TileScheduler::orderTiles(tiles, tilesOrder);
   }
 
   void ThreadRunner::terminate ()
   {
-    QMutexLocker locker(mutex.data());
-
-    renderParams->allowRunning = false;
+    //Mutex is held by run for the whole frame, so it isn't locked here
+    renderParams->allowRunning.store(false, std::memory_order_relaxed);
   }
 
 } /* namespace Controller */
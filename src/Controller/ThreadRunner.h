@@ -10,6 +10,9 @@
 
 #include <common.h>
 
+#include "Controller/TileScheduler.h"
+#include "Model/RenderStats.h"
+
 //Forward declarations -->
 class QMutex;
 class QThreadPool;
@@ -29,7 +32,9 @@ namespace Controller
   struct RenderParams;
   // <-- Forward declarations
 
-  /**Creates threads for image rendering
+  /**Runs render workers for image rendering
+   * There is one persistent worker per thread, each with its own renderer.
+   * Tiles are distributed between workers by tile scheduler.
    *
    */
   class ThreadRunner: public QObject, public QRunnable
@@ -48,32 +53,36 @@ namespace Controller
       void setParams (const std::shared_ptr <Model::RenderTileData> &image,
                       const std::shared_ptr <RenderParams> &newRenderParams);
 
-      /**Runs rendering with threads.
-       * Threads above maxThreadCount are added to queue.
+      /**Runs rendering with maxThreadCount workers.
+       * Workers are created or removed when thread count changes.
        */
       virtual void run ();
 
+      /**Returns counters of the last rendered frame summed over all workers
+       * Counters are zero when they are compiled out.
+       *
+       * @return render counters
+       */
+      Model::RenderStats getStats () const;
+
     public slots:
       /**Listener for terminate signal
+       * Workers stop at the next scanline; it doesn't wait for them
        *
        */
       void terminate ();
 
-      /**Creates tiles and render threads, each tread renders one tile.
-       * There are created as much threads as tiles.
+      /**Slices image into tiles
        *
        */
       void createTiles ();
 
-      /**Randomizes tiles
+      /**Sets order of tiles in next frames
+       * Random order is shuffled again on each call.
        *
+       * @param order order of tiles
        */
-      void randomizeTiles ();
-
-      /**Sets tile order to default
-       *
-       */
-      void resetTilesOrder ();
+      void setTilesOrder (TileScheduler::Order order);
 
     signals:
       /**Sends signal when all threads done their job
@@ -82,7 +91,7 @@ namespace Controller
       void renderFinished ();
 
     private:
-      bool tilesRandomized;
+      TileScheduler::Order tilesOrder;
 
       /**Stores rendering parameters
        *
@@ -96,25 +105,38 @@ namespace Controller
 
       QScopedPointer <QMutex> mutex;
 
-      /**Container for tiles that are queued
+      /**Distributes tiles between workers
+       *
+       */
+      QScopedPointer <TileScheduler> scheduler;
+
+      /**Container for tiles in default order
        *
        */
       QList <std::shared_ptr <Model::RenderTileData> > tiles;
 
+      /**Container for tiles in order of rendering
+       *
+       */
+      QList <std::shared_ptr <Model::RenderTileData> > tilesOrdered;
+
+      /**Persistent workers, one per thread
+       *
+       */
       QList <std::shared_ptr <RendererThread> > renderers;
-      QList <std::shared_ptr <RendererThread> > renderersRandomized;
 
       std::shared_ptr <Model::RenderTileData> image;
 
-      /**Creates image tile
-       * New tile is added to the end of tile container
+      /**Counters of the last rendered frame
+       *
+       */
+      Model::RenderStats stats;
+
+      /**Creates or removes workers to match given count
        *
-       * @param x tile start x relative to image start
-       * @param y tile start y relative to image start
-       * @param tileSizeX tile width
-       * @param tileSizeY tile height
+       * @param workerCount amount of workers
        */
-      void createTile (int x, int y, int tileSizeX, int tileSizeY);
+      void updateWorkers (int workerCount);
 
       /**Disables copying of object
        *
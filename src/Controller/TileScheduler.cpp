@@ -0,0 +1,400 @@
+/// @file Controller/TileScheduler.cpp
+
+#include <algorithm>
+#include <random>
+#include <QHash>
+
+#include "Controller/TileScheduler.h"
+#include "Model/RenderTileData.h"
+
+//Tiles aren't split below this size
+#define MIN_SUBTILE_SIZE 8
+
+//Each of the last tiles of frame is split into up to 2^TAIL_SPLIT_COUNT parts
+#define TAIL_SPLIT_COUNT 2
+
+namespace Controller
+{
+
+  namespace
+  {
+    /**Returns position of tile on Morton curve
+     * Bits of coordinates are interleaved.
+     *
+     * @param x column of tile
+     * @param y row of tile
+     * @return position on curve
+     */
+    quint64 getMortonKey (quint32 x, quint32 y)
+    {
+      quint64 key = 0;
+
+      for (int bit = 0; bit < 32; ++bit)
+      {
+        key |= static_cast <quint64>( (x >> bit) & 1) << (2 * bit);
+        key |= static_cast <quint64>( (y >> bit) & 1) << (2 * bit + 1);
+      }
+
+      return key;
+    }
+
+    /**Returns position of tile on Hilbert curve
+     * Quadrants are visited so that consecutive tiles are always
+     * neighbours.
+     *
+     * @param x column of tile
+     * @param y row of tile
+     * @param size size of curve; power of 2 greater than coordinates
+     * @return position on curve
+     */
+    quint64 getHilbertKey (quint32 x, quint32 y, quint32 size)
+    {
+      quint64 key = 0;
+
+      for (quint32 half = size / 2; half > 0; half /= 2)
+      {
+        quint32 right = (x & half) > 0 ? 1 : 0;
+        quint32 bottom = (y & half) > 0 ? 1 : 0;
+
+        key += static_cast <quint64>(half) * half * ( (3 * right) ^ bottom);
+
+        //Rotate quadrant, so curve inside it starts next to previous one
+        if (bottom == 0)
+        {
+          if (right == 1)
+          {
+            x = size - 1 - x;
+            y = size - 1 - y;
+          }
+
+          std::swap(x, y);
+        }
+      }
+
+      return key;
+    }
+  }
+
+  TileScheduler::TileScheduler ()
+      : nextTask(0)
+  {
+  }
+
+  TileScheduler::~TileScheduler ()
+  {
+  }
+
+  inline void TileScheduler::createTile (const Model::RenderTileData &image,
+                                         int x,
+                                         int y,
+                                         int tileSizeX,
+                                         int tileSizeY,
+                                         QList <TilePtr> &tiles)
+  {
+    //Copy common data that are needed to render
+    std::shared_ptr <Model::RenderTileData> tile(
+        new Model::RenderTileData(image));
+
+    tile->deleteImageData = false;
+
+    tile->topLeft.x = x;
+    tile->topLeft.y = y;
+    tile->bottomRight.x = tile->topLeft.x + tileSizeX;
+    tile->bottomRight.y = tile->topLeft.y + tileSizeY;
+
+    tile->width = tileSizeX;
+    tile->height = tileSizeY;
+
+    tiles.append(tile);
+  }
+
+  QList <TileScheduler::TilePtr> TileScheduler::createTiles (const Model::RenderTileData &image)
+  {
+    QList <TilePtr> tiles;
+
+    imageUnit tileSize = image.width;
+    div_t tilesX = div(image.imageWidth, tileSize);
+    div_t tilesY = div(image.imageHeight, tileSize);
+    imageUnit tileXLimit = image.imageWidth - tilesX.rem;
+    imageUnit tileYLimit = image.imageHeight - tilesY.rem;
+    int tilesNumber = tilesX.quot * tilesY.quot;
+
+    tilesNumber += tilesX.rem > 0 ? 1 : 0;
+    tilesNumber += tilesY.rem > 0 ? 1 : 0;
+
+    tiles.reserve(tilesNumber);
+
+    //Slice image into whole tiles
+    for (imageUnit y = 0; y < tileYLimit; y += tileSize)
+    {
+      for (imageUnit x = 0; x < tileXLimit; x += tileSize)
+      {
+        createTile(image, x, y, tileSize, tileSize, tiles);
+      }
+    }
+
+    //Slice bottom part of image (if any) into part tiles
+    if (tilesY.rem > 0)
+    {
+      for (imageUnit x = 0; x < tileXLimit; x += tileSize)
+      {
+        createTile(image, x, tileYLimit, tileSize, tilesY.rem, tiles);
+      }
+    }
+
+    //Slice right part of image (if any) into part tiles
+    if (tilesX.rem > 0)
+    {
+      for (imageUnit y = 0; y < tileYLimit; y += tileSize)
+      {
+        createTile(image, tileXLimit, y, tilesX.rem, tileSize, tiles);
+      }
+    }
+
+    //Create tile for right bottom corner if left
+    if (tilesX.rem > 0 && tilesY.rem > 0)
+    {
+      createTile(image, tileXLimit, tileYLimit, tilesX.rem, tilesY.rem, tiles);
+    }
+
+    return tiles;
+  }
+
+  QList <TileScheduler::TilePtr> TileScheduler::orderTiles (const QList <TilePtr> &tiles,
+                                                            Order order)
+  {
+    QList <TilePtr> ordered(tiles);
+
+    if (order == CostOrder || tiles.size() < 2)
+    {
+      return ordered;
+    }
+
+    if (order == RandomOrder)
+    {
+      std::mt19937 generator(std::random_device {}());
+
+      std::shuffle(ordered.begin(), ordered.end(), generator);
+
+      return ordered;
+    }
+
+    //Tiles at right and bottom edge may be smaller
+    imageUnit tileSize = 1;
+
+    for (const TilePtr &tile : tiles)
+    {
+      tileSize = std::max(tileSize, std::max(tile->width, tile->height));
+    }
+
+    const Model::RenderTileData &image = *tiles.first();
+    quint32 curveSize = 1;
+
+    while (curveSize * tileSize < static_cast <quint32>(image.imageWidth)
+        || curveSize * tileSize < static_cast <quint32>(image.imageHeight))
+    {
+      curveSize *= 2;
+    }
+
+    QVector <quint64> keys(tiles.size());
+    QVector <int> indices(tiles.size());
+
+    for (int i = 0; i < tiles.size(); ++i)
+    {
+      const Model::RenderTileData &tile = *tiles [i];
+      quint32 x = tile.topLeft.x / tileSize;
+      quint32 y = tile.topLeft.y / tileSize;
+
+      if (order == MortonOrder)
+      {
+        keys [i] = getMortonKey(x, y);
+      }
+      else if (order == HilbertOrder)
+      {
+        keys [i] = getHilbertKey(x, y, curveSize);
+      }
+      else
+      {
+        //Square of doubled distance between centers of tile and image
+        qint64 dx = 2 * tile.topLeft.x + tile.width - image.imageWidth;
+        qint64 dy = 2 * tile.topLeft.y + tile.height - image.imageHeight;
+
+        keys [i] = dx * dx + dy * dy;
+      }
+
+      indices [i] = i;
+    }
+
+    std::stable_sort(indices.begin(), indices.end(), [&keys] (int a, int b)
+    {
+      return keys [a] < keys [b];
+    });
+
+    for (int i = 0; i < tiles.size(); ++i)
+    {
+      ordered [i] = tiles [indices [i]];
+    }
+
+    return ordered;
+  }
+
+  void TileScheduler::collectCosts (const QList <TilePtr> &tiles)
+  {
+    //Index of each tile in previous frame; order may differ between frames
+    QHash <const Model::RenderTileData *, int> lastIndices;
+
+    for (int i = 0; i < lastTiles.size(); ++i)
+    {
+      lastIndices.insert(lastTiles [i].get(), i);
+    }
+
+    bool sameTiles = tiles.size() == lastTiles.size();
+
+    for (int i = 0; sameTiles && i < tiles.size(); ++i)
+    {
+      sameTiles = lastIndices.contains(tiles [i].get());
+    }
+
+    if (!sameTiles)
+    {
+      lastTiles = tiles;
+      lastCosts.fill(0, tiles.size());
+      return;
+    }
+
+    QVector <qint64> frameCosts(lastTiles.size());
+    bool measured = false;
+
+    for (const std::vector <qint64> &costs : workerCosts)
+    {
+      for (size_t i = 0; i < costs.size(); ++i)
+      {
+        frameCosts [i] += costs [i];
+        measured = measured || costs [i] > 0;
+      }
+    }
+
+    //Frame which rendered nothing (e.g. terminated at once) keeps old costs
+    if (!measured)
+    {
+      frameCosts = lastCosts;
+    }
+
+    //Keep costs indexed by position in the new list
+    for (int i = 0; i < tiles.size(); ++i)
+    {
+      lastCosts [i] = frameCosts [lastIndices.value(tiles [i].get())];
+    }
+
+    lastTiles = tiles;
+  }
+
+  void TileScheduler::distribute (const QList <TilePtr> &tiles,
+                                  int workerCount,
+                                  bool sortByCost)
+  {
+    if (workerCount < 1)
+    {
+      workerCount = 1;
+    }
+
+    collectCosts(tiles);
+
+    workerCosts.resize(workerCount);
+
+    for (std::vector <qint64> &costs : workerCosts)
+    {
+      costs.assign(tiles.size(), 0);
+    }
+
+    int tileCount = tiles.size();
+    QVector <int> order(tileCount);
+
+    for (int i = 0; i < tileCount; ++i)
+    {
+      order [i] = i;
+    }
+
+    if (sortByCost)
+    {
+      const QVector <qint64> &costs = lastCosts;
+
+      std::stable_sort(order.begin(), order.end(), [&costs] (int a, int b)
+      {
+        return costs [a] > costs [b];
+      });
+    }
+
+    tasks.clear();
+    tasks.reserve(tileCount + workerCount * ( (1 << TAIL_SPLIT_COUNT) - 1));
+
+    //Workers which finished earlier take parts of the last tiles
+    int tailStart = std::max(tileCount - workerCount, 0);
+
+    for (int i = 0; i < tileCount; ++i)
+    {
+      addTask(tiles [order [i]], order [i],
+              i < tailStart ? 0 : TAIL_SPLIT_COUNT);
+    }
+
+    nextTask.store(0, std::memory_order_relaxed);
+  }
+
+  bool TileScheduler::takeTile (TilePtr &tile, int &tileIdx)
+  {
+    //Workers are started after tasks are stored, so only index is shared
+    int taskIdx = nextTask.fetch_add(1, std::memory_order_relaxed);
+
+    if (taskIdx >= tasks.size())
+    {
+      return false;
+    }
+
+    const Task &task = tasks.at(taskIdx);
+
+    tile = task.tile;
+    tileIdx = task.tileIdx;
+
+    return true;
+  }
+
+  void TileScheduler::addTask (const TilePtr &tile, int tileIdx, int splitCount)
+  {
+    bool splitX = tile->width >= tile->height;
+    imageUnit size = splitX ? tile->width : tile->height;
+
+    if (splitCount == 0 || size < 2 * MIN_SUBTILE_SIZE)
+    {
+      Task task;
+
+      task.tile = tile;
+      task.tileIdx = tileIdx;
+      tasks.append(task);
+
+      return;
+    }
+
+    TilePtr first(new Model::RenderTileData( *tile));
+    TilePtr second(new Model::RenderTileData( *tile));
+    imageUnit half = size / 2;
+
+    if (splitX)
+    {
+      first->width = half;
+      first->bottomRight.x = first->topLeft.x + half;
+      second->width = size - half;
+      second->topLeft.x = first->bottomRight.x;
+    }
+    else
+    {
+      first->height = half;
+      first->bottomRight.y = first->topLeft.y + half;
+      second->height = size - half;
+      second->topLeft.y = first->bottomRight.y;
+    }
+
+    addTask(first, tileIdx, splitCount - 1);
+    addTask(second, tileIdx, splitCount - 1);
+  }
+
+} /* namespace Controller */
@@ -0,0 +1,181 @@
+/// @file Controller/TileScheduler.h
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <QList>
+#include <QVector>
+
+#include <common.h>
+
+//Forward declarations -->
+namespace Model
+{
+  class RenderTileData;
+}  // namespace Model
+// <-- Forward declarations
+
+namespace Controller
+{
+
+  /**Distributes tiles between render workers
+   * Tiles of frame are ordered before workers start and stored in one
+   * array. Workers take them by atomic increment of shared index, so
+   * taking tile never waits for other workers.
+   *
+   * Render time of every tile is measured. Next frame starts with
+   * the most expensive tiles and the last tiles of frame are split into
+   * smaller subtiles, so workers finish at about the same time.
+   *
+   */
+  class TileScheduler
+  {
+    public:
+      typedef std::shared_ptr <Model::RenderTileData> TilePtr;
+
+      /**Orders of tiles
+       * Cost order starts with tiles which were the most expensive in
+       * previous frame. Morton and Hilbert orders follow space filling
+       * curves, so tiles rendered at the same time are close to each other
+       * and share cached parts of the scene. Center out order renders
+       * middle of image first, which suits interactive preview.
+       *
+       */
+      enum Order
+      {
+        CostOrder, RandomOrder, MortonOrder, HilbertOrder, CenterOutOrder
+      };
+
+      TileScheduler ();
+      ~TileScheduler ();
+
+      /**Slices image into tiles
+       * Tile size is given by width of image description. Tiles at right
+       * and bottom edge are smaller if image size isn't multiple of it.
+       *
+       * @param image image description
+       * @return tiles in row-major order
+       */
+      static QList <TilePtr> createTiles (const Model::RenderTileData &image);
+
+      /**Returns tiles in given order
+       *
+       * @param tiles tiles created by createTiles
+       * @param order order of tiles; cost order keeps given order,
+       *   because tiles are sorted by distribute
+       * @return ordered tiles
+       */
+      static QList <TilePtr> orderTiles (const QList <TilePtr> &tiles,
+                                         Order order);
+
+      /**Prepares tiles of new frame
+       * It has to be called before workers are started.
+       *
+       * @param tiles tiles to render, in order of rendering
+       * @param workerCount amount of workers
+       * @param sortByCost if true, tiles which were the most expensive
+       *   in previous frame are rendered first
+       */
+      void distribute (const QList <TilePtr> &tiles,
+                       int workerCount,
+                       bool sortByCost);
+
+      /**Takes next tile
+       * Thread safe and lock-free
+       *
+       * @param tile next tile to render; it may be a part of given tile
+       * @param tileIdx index of given tile, used to report cost
+       * @return false if all tiles of frame were taken
+       */
+      bool takeTile (TilePtr &tile, int &tileIdx);
+
+      /**Adds render time to cost of tile
+       * Each worker writes only to its own counters, so it isn't locked
+       *
+       * @param workerIdx index of worker
+       * @param tileIdx index of tile returned by takeTile
+       * @param cost render time in nanoseconds
+       */
+      inline void addCost (int workerIdx, int tileIdx, qint64 cost)
+      {
+        workerCosts [workerIdx] [tileIdx] += cost;
+      }
+
+    private:
+      /**Tile or part of it
+       *
+       */
+      struct Task
+      {
+          TilePtr tile;
+          int tileIdx;
+      };
+
+      /**Tasks of frame in order of rendering
+       * They aren't changed while workers run
+       *
+       */
+      QVector <Task> tasks;
+
+      /**Index of the next task to take
+       *
+       */
+      std::atomic <int> nextTask;
+
+      /**Costs of tiles rendered by each worker in current frame
+       *
+       */
+      std::vector <std::vector <qint64> > workerCosts;
+
+      /**Tiles of previous frame, in default order
+       *
+       */
+      QList <TilePtr> lastTiles;
+
+      /**Costs of tiles in previous frame
+       *
+       */
+      QVector <qint64> lastCosts;
+
+      /**Creates image tile
+       * New tile is added to the end of tile container
+       *
+       * @param image image description
+       * @param x tile start x relative to image start
+       * @param y tile start y relative to image start
+       * @param tileSizeX tile width
+       * @param tileSizeY tile height
+       * @param tiles tile container
+       */
+      static void createTile (const Model::RenderTileData &image,
+                              int x,
+                              int y,
+                              int tileSizeX,
+                              int tileSizeY,
+                              QList <TilePtr> &tiles);
+
+      /**Collects costs measured by workers in previous frame
+       * Costs are dropped if tiles has changed
+       *
+       * @param tiles tiles of new frame
+       */
+      void collectCosts (const QList <TilePtr> &tiles);
+
+      /**Adds task for tile split in halves given amount of times
+       * Tiles aren't split below MIN_SUBTILE_SIZE
+       *
+       * @param tile tile to render
+       * @param tileIdx index of given tile
+       * @param splitCount how many times tile is split in halves
+       */
+      void addTask (const TilePtr &tile, int tileIdx, int splitCount);
+
+      /**Disables copying of object
+       *
+       */
+      Q_DISABLE_COPY (TileScheduler)
+  };
+
+} /* namespace Controller */
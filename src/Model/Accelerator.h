@@ -0,0 +1,104 @@
+/// @file Model/Accelerator.h
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Model/ModelDefines.h"
+
+namespace Model
+{
+  //Forward declarations -->
+  struct PacketHit;
+  class Ray;
+  struct RayPacket;
+  struct RenderStats;
+  class Vector;
+  class VisibleObject;
+  // <-- Forward declarations
+
+  /**Acceleration structure over bounded objects of scene
+   * Renderer finds intersections only through this interface, so
+   * structures can be switched per scene.
+   *
+   */
+  class Accelerator
+  {
+    public:
+      typedef std::vector <const VisibleObject *> ObjectContainer;
+
+      inline virtual ~Accelerator ()
+      {
+      }
+
+      /**Builds structure over given objects
+       * All objects have to be bounded.
+       *
+       * @param newObjects objects to build structure over
+       */
+      virtual void build (const ObjectContainer &newObjects) = 0;
+
+      /**Updates structure after objects were moved or resized
+       *
+       * @return false if structure should be built again
+       */
+      virtual bool refit () = 0;
+
+      /**Removes all objects
+       *
+       */
+      virtual void clear () = 0;
+
+      /**Finds closest object which intersects with given ray
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param tmpDist temporary vector for calculations
+       * @param stats counters of intersection tests
+       * @return closest intersected object or nullptr if there's no intersection
+       */
+      virtual const VisibleObject *findIntersection (const Ray &ray,
+                                                     worldUnit &range,
+                                                     Vector &tmpDist,
+                                                     RenderStats &stats) const = 0;
+
+      /**Finds closest objects which intersect with packet of rays
+       *
+       * @param packet rays to check intersection with
+       * @param hit closest intersections; ranges are shortened on hit
+       * @param stats counters of intersection tests
+       */
+      virtual void findIntersections (const RayPacket &packet,
+                                      PacketHit &hit,
+                                      RenderStats &stats) const = 0;
+
+      /**Finds any object which intersects with given ray in given range
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray
+       * @param tmpDist temporary vector for calculations
+       * @param stats counters of intersection tests
+       * @return intersected object or nullptr if there's no intersection
+       */
+      virtual const VisibleObject *findAnyIntersection (const Ray &ray,
+                                                        worldUnit range,
+                                                        Vector &tmpDist,
+                                                        RenderStats &stats) const = 0;
+
+      /**Returns true if structure has no objects
+       *
+       * @return is structure empty
+       */
+      virtual bool isEmpty () const = 0;
+
+      /**Returns memory allocated by the structure
+       *
+       * @return size in bytes
+       */
+      virtual size_t getMemoryUsage () const = 0;
+  };
+
+  typedef std::unique_ptr <Accelerator> AcceleratorUniquePtr;
+
+} /* namespace Model */
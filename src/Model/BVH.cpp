@@ -0,0 +1,718 @@
+/// @file Model/BVH.cpp
+
+#include <algorithm>
+
+#include "Model/BVH.h"
+#include "Model/Ray.h"
+#include "Model/RayPacket.h"
+#include "Model/RenderStats.h"
+#include "Model/Vector.h"
+#include "Model/VisibleObject.h"
+
+//Number of bins used to evaluate split planes on each axis
+#define BVH_BIN_COUNT 16
+
+//Cost of traversing node relative to cost of intersecting object
+#define BVH_TRAVERSAL_COST 1.0f
+
+//Leaves bigger than this are split even if SAH says they shouldn't be
+#define BVH_MAX_LEAF_SIZE 8
+
+//Refitted tree is built again when its cost grows more than this times
+#define BVH_MAX_REFIT_DEGRADATION 1.5f
+
+namespace Model
+{
+
+  /**Object data used during tree building
+   *
+   */
+  struct BVH::BuildEntry
+  {
+      BoundingBox bounds;
+      Point center;
+      const VisibleObject *object;
+  };
+
+  namespace
+  {
+    /**Bin used by binned surface area heuristic
+     *
+     */
+    struct Bin
+    {
+        BoundingBox bounds;
+        uint32_t count;
+
+        Bin ()
+            : count(0)
+        {
+        }
+    };
+
+    /**Node waiting for traversal with distance to its box
+     *
+     */
+    struct StackEntry
+    {
+        uint32_t nodeIdx;
+        worldUnit distance;
+    };
+
+    /**Checks which rays of packet hit the box in their range
+     *
+     * @param box box to check intersection with
+     * @param packet rays to check intersection with
+     * @param range ranges of rays
+     * @param distance the smallest distance to box among rays that hit it
+     * @return bit mask of rays that hit the box
+     */
+    inline int checkPacket (const BoundingBox &box,
+                            const RayPacket &packet,
+                            const PacketFloat &range,
+                            worldUnit &distance)
+    {
+      const Point &min = box.getMin();
+      const Point &max = box.getMax();
+
+      PacketFloat t1 = packetMul(packetSub(packetSet(min [X]), packet.startX),
+                                 packet.invDirX);
+      PacketFloat t2 = packetMul(packetSub(packetSet(max [X]), packet.startX),
+                                 packet.invDirX);
+      PacketFloat entry = packetMin(t1, t2);
+      PacketFloat exit = packetMax(t1, t2);
+
+      t1 = packetMul(packetSub(packetSet(min [Y]), packet.startY),
+                     packet.invDirY);
+      t2 = packetMul(packetSub(packetSet(max [Y]), packet.startY),
+                     packet.invDirY);
+      entry = packetMax(entry, packetMin(t1, t2));
+      exit = packetMin(exit, packetMax(t1, t2));
+
+      t1 = packetMul(packetSub(packetSet(min [Z]), packet.startZ),
+                     packet.invDirZ);
+      t2 = packetMul(packetSub(packetSet(max [Z]), packet.startZ),
+                     packet.invDirZ);
+      entry = packetMax(entry, packetMin(t1, t2));
+      exit = packetMin(exit, packetMax(t1, t2));
+
+      PacketFloat zero = packetSet(0.0f);
+      entry = packetMax(entry, zero);
+
+      PacketFloat mask = packetAnd(packetLessEqual(entry, exit),
+                                   packetLess(zero, exit));
+      mask = packetAnd(mask, packetLess(entry, range));
+
+      int bits = packetMask(mask);
+
+      if (bits != 0)
+      {
+        alignas(32) float entries [PACKET_SIZE];
+        packetStore(entries, entry);
+
+        distance = std::numeric_limits <worldUnit>::max();
+        for (int lane = 0; lane < PACKET_SIZE; ++lane)
+        {
+          if ( (bits & (1 << lane)) && entries [lane] < distance)
+          {
+            distance = entries [lane];
+          }
+        }
+      }
+
+      return bits;
+    }
+  }
+
+  BVH::BVH ()
+      : buildCost(0.0f)
+  {
+  }
+
+  void BVH::clear ()
+  {
+    nodes.clear();
+    objects.clear();
+    sphereStore.clear();
+    buildCost = 0.0f;
+  }
+
+  void BVH::build (const ObjectContainer &newObjects)
+  {
+    clear();
+
+    if (newObjects.empty())
+    {
+      return;
+    }
+
+    BuildContainer entries(newObjects.size());
+    Node root;
+
+    root.leftFirst = 0;
+    root.count = newObjects.size();
+    root.sphereCount = 0;
+
+    for (size_t i = 0; i < newObjects.size(); ++i)
+    {
+      BuildEntry &entry = entries [i];
+
+      entry.object = newObjects [i];
+      entry.object->getBoundingBox(entry.bounds);
+      entry.center = entry.bounds.getCenter();
+
+      root.bounds.extend(entry.bounds);
+    }
+
+    //Binary tree has at most 2n - 1 nodes, reserving avoids reallocation
+    nodes.reserve(newObjects.size() * 2);
+    nodes.push_back(root);
+
+    subdivide(0, entries, 0);
+
+    objects.reserve(entries.size());
+    for (const BuildEntry &entry : entries)
+    {
+      objects.push_back(entry.object);
+    }
+
+    nodes.shrink_to_fit();
+
+    packSpheres();
+    buildCost = calculateCost();
+  }
+
+  void BVH::restore (NodeContainer &&newNodes, const ObjectContainer &newObjects)
+  {
+    clear();
+
+    nodes = std::move(newNodes);
+    objects = newObjects;
+
+    packSpheres();
+    buildCost = calculateCost();
+  }
+
+  size_t BVH::getMemoryUsage () const
+  {
+    return nodes.capacity() * sizeof(Node)
+        + objects.capacity() * sizeof(const VisibleObject *)
+        + sphereStore.getMemoryUsage();
+  }
+
+  bool BVH::refit ()
+  {
+    BoundingBox box;
+
+    //Children are always placed after their parent, so they are
+    //updated first when nodes are visited backwards
+    for (NodeContainer::reverse_iterator node = nodes.rbegin();
+        node != nodes.rend(); ++node)
+    {
+      node->bounds.reset();
+
+      if (node->isLeaf())
+      {
+        for (uint32_t i = node->leftFirst; i < node->leftFirst + node->count;
+            ++i)
+        {
+          objects [i]->getBoundingBox(box);
+          node->bounds.extend(box);
+        }
+      }
+      else
+      {
+        node->bounds.extend(nodes [node->leftFirst].bounds);
+        node->bounds.extend(nodes [node->leftFirst + 1].bounds);
+      }
+    }
+
+    //Spheres are copied, so their new positions have to be copied too
+    sphereStore.build(objects);
+
+    return calculateCost() <= buildCost * BVH_MAX_REFIT_DEGRADATION;
+  }
+
+  worldUnit BVH::calculateCost () const
+  {
+    worldUnit cost = 0.0f;
+
+    if (nodes.empty())
+    {
+      return cost;
+    }
+
+    for (const Node &node : nodes)
+    {
+      worldUnit area = node.bounds.getSurfaceArea();
+
+      cost += node.isLeaf() ? node.count * area : BVH_TRAVERSAL_COST * area;
+    }
+
+    worldUnit rootArea = nodes [0].bounds.getSurfaceArea();
+
+    return rootArea > 0.0f ? cost / rootArea : cost;
+  }
+
+  void BVH::packSpheres ()
+  {
+    for (Node &node : nodes)
+    {
+      if (!node.isLeaf())
+      {
+        continue;
+      }
+
+      ObjectContainer::iterator first = objects.begin() + node.leftFirst;
+      ObjectContainer::iterator middle = std::stable_partition(
+          first, first + node.count, SphereStore::isSphere);
+
+      node.sphereCount = middle - first;
+    }
+
+    sphereStore.build(objects);
+  }
+
+  void BVH::subdivide (uint32_t nodeIdx, BuildContainer &entries, int depth)
+  {
+    Node &node = nodes [nodeIdx];
+
+    if (node.count <= 1 || depth >= BVH_MAX_DEPTH - 1)
+    {
+      return;
+    }
+
+    int axis;
+    worldUnit splitPosition;
+    worldUnit splitCost = findBestSplit(node, entries, axis, splitPosition);
+    worldUnit nodeArea = node.bounds.getSurfaceArea();
+    worldUnit leafCost = node.count * nodeArea;
+
+    if (splitCost < 0.0f
+        || (splitCost + BVH_TRAVERSAL_COST * nodeArea >= leafCost
+            && node.count <= BVH_MAX_LEAF_SIZE))
+    {
+      return;
+    }
+
+    //Partition objects by split plane
+    BuildContainer::iterator first = entries.begin() + node.leftFirst;
+    BuildContainer::iterator last = first + node.count;
+    BuildContainer::iterator middle = std::partition(
+        first, last, [axis, splitPosition] (const BuildEntry &entry)
+        {
+          return entry.center [axis] < splitPosition;
+        });
+
+    uint32_t leftCount = middle - first;
+
+    if (leftCount == 0 || leftCount == node.count)
+    {
+      return;
+    }
+
+    Node left, right;
+
+    left.leftFirst = node.leftFirst;
+    left.count = leftCount;
+    left.sphereCount = 0;
+    right.leftFirst = node.leftFirst + leftCount;
+    right.count = node.count - leftCount;
+    right.sphereCount = 0;
+
+    for (BuildContainer::iterator it = first; it != middle; ++it)
+    {
+      left.bounds.extend(it->bounds);
+    }
+
+    for (BuildContainer::iterator it = middle; it != last; ++it)
+    {
+      right.bounds.extend(it->bounds);
+    }
+
+    uint32_t leftIdx = nodes.size();
+
+    node.leftFirst = leftIdx;
+    node.count = 0;
+
+    //node is invalid from here, nodes may be reallocated
+    nodes.push_back(left);
+    nodes.push_back(right);
+
+    subdivide(leftIdx, entries, depth + 1);
+    subdivide(leftIdx + 1, entries, depth + 1);
+  }
+
+  worldUnit BVH::findBestSplit (const Node &node,
+                                const BuildContainer &entries,
+                                int &axis,
+                                worldUnit &splitPosition) const
+  {
+    worldUnit bestCost = -1.0f;
+    BoundingBox centroidBounds;
+
+    for (uint32_t i = 0; i < node.count; ++i)
+    {
+      centroidBounds.extend(entries [node.leftFirst + i].center);
+    }
+
+    for (int currentAxis = Z; currentAxis <= X; ++currentAxis)
+    {
+      worldUnit boundsMin = centroidBounds.getMin() [currentAxis];
+      worldUnit boundsMax = centroidBounds.getMax() [currentAxis];
+
+      if (! (boundsMax > boundsMin))
+      {
+        continue;
+      }
+
+      Bin bins [BVH_BIN_COUNT];
+      worldUnit scale = BVH_BIN_COUNT / (boundsMax - boundsMin);
+
+      for (uint32_t i = 0; i < node.count; ++i)
+      {
+        const BuildEntry &entry = entries [node.leftFirst + i];
+        int binIdx = std::min(
+            BVH_BIN_COUNT - 1,
+            static_cast <int>( (entry.center [currentAxis] - boundsMin)
+                * scale));
+
+        ++bins [binIdx].count;
+        bins [binIdx].bounds.extend(entry.bounds);
+      }
+
+      //Sweep from both sides to get area and count on each side of planes
+      worldUnit leftArea [BVH_BIN_COUNT - 1];
+      worldUnit rightArea [BVH_BIN_COUNT - 1];
+      uint32_t leftCount [BVH_BIN_COUNT - 1];
+      uint32_t rightCount [BVH_BIN_COUNT - 1];
+      BoundingBox leftBox, rightBox;
+      uint32_t leftSum = 0, rightSum = 0;
+
+      for (int i = 0; i < BVH_BIN_COUNT - 1; ++i)
+      {
+        leftSum += bins [i].count;
+        leftCount [i] = leftSum;
+        leftBox.extend(bins [i].bounds);
+        leftArea [i] = leftBox.getSurfaceArea();
+
+        rightSum += bins [BVH_BIN_COUNT - 1 - i].count;
+        rightCount [BVH_BIN_COUNT - 2 - i] = rightSum;
+        rightBox.extend(bins [BVH_BIN_COUNT - 1 - i].bounds);
+        rightArea [BVH_BIN_COUNT - 2 - i] = rightBox.getSurfaceArea();
+      }
+
+      worldUnit binWidth = (boundsMax - boundsMin) / BVH_BIN_COUNT;
+
+      for (int i = 0; i < BVH_BIN_COUNT - 1; ++i)
+      {
+        if (leftCount [i] == 0 || rightCount [i] == 0)
+        {
+          continue;
+        }
+
+        worldUnit cost = leftCount [i] * leftArea [i]
+            + rightCount [i] * rightArea [i];
+
+        if (bestCost < 0.0f || cost < bestCost)
+        {
+          bestCost = cost;
+          axis = currentAxis;
+          splitPosition = boundsMin + binWidth * (i + 1);
+        }
+      }
+    }
+
+    return bestCost;
+  }
+
+  const VisibleObject *BVH::findIntersection (const Ray &ray,
+                                              worldUnit &range,
+                                              Vector &tmpDist,
+                                              RenderStats &stats) const
+  {
+    const VisibleObject *closestObject = nullptr;
+    worldUnit distance;
+
+    if (nodes.empty())
+    {
+      return closestObject;
+    }
+
+    Vector invDir;
+    BoundingBox::invertDirection(ray.getDir(), invDir);
+
+    if (!nodes [0].bounds.checkRay(ray, invDir, range, distance))
+    {
+      return closestObject;
+    }
+
+    StackEntry stack [BVH_MAX_DEPTH];
+    int stackSize = 0;
+    const Node *node = &nodes [0];
+
+    while (true)
+    {
+      if (node->isLeaf())
+      {
+        RENDER_STATS_ADD(stats.intersectionTests, node->count);
+
+        const VisibleObject *closestSphere = sphereStore.findIntersection(
+            ray, node->leftFirst, node->sphereCount, range);
+
+        if (closestSphere != nullptr)
+        {
+          closestObject = closestSphere;
+        }
+
+        //Other objects are checked one by one
+        const VisibleObject * const *object = &objects [node->leftFirst];
+        const VisibleObject * const *lastObject = object + node->count;
+
+        for (object += node->sphereCount; object != lastObject; ++object)
+        {
+          if ( (*object)->checkRay(ray, range, tmpDist))
+          {
+            closestObject = *object;
+          }
+        }
+      }
+      else
+      {
+        const Node *left = &nodes [node->leftFirst];
+        const Node *right = left + 1;
+        worldUnit leftDistance, rightDistance;
+        bool leftHit = left->bounds.checkRay(ray, invDir, range, leftDistance);
+        bool rightHit = right->bounds.checkRay(ray, invDir, range,
+                                               rightDistance);
+
+        if (leftHit && rightHit)
+        {
+          //Visit closer child first, farther one may be culled later
+          if (rightDistance < leftDistance)
+          {
+            std::swap(left, right);
+            std::swap(leftDistance, rightDistance);
+          }
+
+          stack [stackSize].nodeIdx = right - &nodes [0];
+          stack [stackSize].distance = rightDistance;
+          ++stackSize;
+
+          node = left;
+          continue;
+        }
+        else if (leftHit)
+        {
+          node = left;
+          continue;
+        }
+        else if (rightHit)
+        {
+          node = right;
+          continue;
+        }
+      }
+
+      //Take next node which is still in range
+      node = nullptr;
+      while (stackSize > 0)
+      {
+        --stackSize;
+        if (stack [stackSize].distance < range)
+        {
+          node = &nodes [stack [stackSize].nodeIdx];
+          break;
+        }
+      }
+
+      if (node == nullptr)
+      {
+        break;
+      }
+    }
+
+    return closestObject;
+  }
+
+  void BVH::findIntersections (const RayPacket &packet,
+                               PacketHit &hit,
+                               RenderStats &stats) const
+  {
+    worldUnit distance;
+
+    if (nodes.empty() || checkPacket(nodes [0].bounds, packet, hit.range,
+                                     distance) == 0)
+    {
+      return;
+    }
+
+    uint32_t stack [BVH_MAX_DEPTH];
+    int stackSize = 0;
+    uint32_t nodeIdx = 0;
+
+    while (true)
+    {
+      const Node &node = nodes [nodeIdx];
+
+      if (node.isLeaf())
+      {
+        RENDER_STATS_ADD(stats.intersectionTests,
+                         node.count * packet.rayCount);
+
+        sphereStore.findIntersections(packet, node.leftFirst,
+                                      node.sphereCount, hit);
+
+        //Other objects are checked one by one
+        for (uint32_t i = node.leftFirst + node.sphereCount;
+            i < node.leftFirst + node.count; ++i)
+        {
+          objects [i]->checkRays(packet, hit);
+        }
+      }
+      else
+      {
+        uint32_t leftIdx = node.leftFirst;
+        uint32_t rightIdx = leftIdx + 1;
+        worldUnit leftDistance, rightDistance;
+        bool leftHit = checkPacket(nodes [leftIdx].bounds, packet, hit.range,
+                                   leftDistance) != 0;
+        bool rightHit = checkPacket(nodes [rightIdx].bounds, packet, hit.range,
+                                    rightDistance) != 0;
+
+        if (leftHit && rightHit)
+        {
+          //Visit child closer to the packet first
+          if (rightDistance < leftDistance)
+          {
+            std::swap(leftIdx, rightIdx);
+          }
+
+          stack [stackSize++ ] = rightIdx;
+          nodeIdx = leftIdx;
+          continue;
+        }
+        else if (leftHit)
+        {
+          nodeIdx = leftIdx;
+          continue;
+        }
+        else if (rightHit)
+        {
+          nodeIdx = rightIdx;
+          continue;
+        }
+      }
+
+      //Ranges could be shortened since node was pushed, so check it again
+      nodeIdx = 0;
+      while (stackSize > 0)
+      {
+        --stackSize;
+        if (checkPacket(nodes [stack [stackSize]].bounds, packet, hit.range,
+                        distance) != 0)
+        {
+          nodeIdx = stack [stackSize];
+          break;
+        }
+      }
+
+      if (nodeIdx == 0)
+      {
+        break;
+      }
+    }
+  }
+
+  const VisibleObject *BVH::findAnyIntersection (const Ray &ray,
+                                                 worldUnit range,
+                                                 Vector &tmpDist,
+                                                 RenderStats &stats) const
+  {
+    worldUnit distance;
+
+    if (nodes.empty())
+    {
+      return nullptr;
+    }
+
+    Vector invDir;
+    BoundingBox::invertDirection(ray.getDir(), invDir);
+
+    if (!nodes [0].bounds.checkRay(ray, invDir, range, distance))
+    {
+      return nullptr;
+    }
+
+    //Order of visiting doesn't matter here, so only node indices are stored
+    uint32_t stack [BVH_MAX_DEPTH];
+    int stackSize = 0;
+    uint32_t nodeIdx = 0;
+
+    while (true)
+    {
+      const Node &node = nodes [nodeIdx];
+
+      if (node.isLeaf())
+      {
+        RENDER_STATS_ADD(stats.intersectionTests, node.count);
+
+        const VisibleObject *occluder = sphereStore.findAnyIntersection(
+            ray, node.leftFirst, node.sphereCount, range);
+
+        if (occluder != nullptr)
+        {
+          return occluder;
+        }
+
+        const VisibleObject * const *object = &objects [node.leftFirst];
+        const VisibleObject * const *lastObject = object + node.count;
+
+        for (object += node.sphereCount; object != lastObject; ++object)
+        {
+          //checkRay shortens range on hit, each object gets its own copy
+          worldUnit objectRange = range;
+
+          if ( (*object)->checkRay(ray, objectRange, tmpDist))
+          {
+            return *object;
+          }
+        }
+      }
+      else
+      {
+        bool leftHit = nodes [node.leftFirst].bounds.checkRay(ray, invDir,
+                                                              range, distance);
+        bool rightHit = nodes [node.leftFirst + 1].bounds.checkRay(ray, invDir,
+                                                                   range,
+                                                                   distance);
+
+        if (leftHit)
+        {
+          if (rightHit)
+          {
+            stack [stackSize++ ] = node.leftFirst + 1;
+          }
+
+          nodeIdx = node.leftFirst;
+          continue;
+        }
+        else if (rightHit)
+        {
+          nodeIdx = node.leftFirst + 1;
+          continue;
+        }
+      }
+
+      if (stackSize == 0)
+      {
+        break;
+      }
+
+      nodeIdx = stack [--stackSize];
+    }
+
+    return nullptr;
+  }
+
+} /* namespace Model */
@@ -0,0 +1,208 @@
+/// @file Model/BVH.h
+
+#pragma once
+
+#include <vector>
+
+#include "Model/Accelerator.h"
+#include "Model/BoundingBox.h"
+#include "Model/ModelDefines.h"
+#include "Model/SphereStore.h"
+
+//Limits depth of the tree; traversal stack has the same size
+#define BVH_MAX_DEPTH 64
+
+namespace Model
+{
+  /**Bounding volume hierarchy
+   * Binary tree of bounding boxes built with surface area heuristic.
+   * It's used to find closest intersection of ray with bounded objects.
+   *
+   */
+  class BVH: public Accelerator
+  {
+    public:
+      /**Node of the tree
+       * Inner node keeps index of its left child in leftFirst,
+       * right child is placed just after left one.
+       * Leaf keeps index of its first object in leftFirst
+       * and amount of objects in count. Spheres are placed at the
+       * beginning of leaf, there are sphereCount of them.
+       *
+       */
+      struct Node
+      {
+          BoundingBox bounds;
+          uint32_t leftFirst;
+          uint32_t count;
+          uint32_t sphereCount;
+
+          inline bool isLeaf () const
+          {
+            return count > 0;
+          }
+      };
+
+      typedef std::vector <Node> NodeContainer;
+
+      BVH ();
+
+      inline virtual ~BVH ()
+      {
+      }
+
+      /**Builds tree over given objects
+       * All objects have to be bounded.
+       *
+       * @param newObjects objects to build tree over
+       */
+      virtual void build (const ObjectContainer &newObjects);
+
+      /**Restores tree built earlier e.g. read from compiled scene
+       * Leaves have to reference objects in given order.
+       *
+       * @param newNodes nodes of the tree
+       * @param newObjects objects ordered as referenced by leaves
+       */
+      void restore (NodeContainer &&newNodes, const ObjectContainer &newObjects);
+
+      /**Updates bounds of nodes after objects were moved or resized
+       * Tree topology is kept, so it takes O(n) time, but tree gets worse
+       * when objects move far from their neighbours.
+       *
+       * @return false if tree is much worse than after build and it
+       * should be built again
+       */
+      virtual bool refit ();
+
+      /**Removes all nodes and objects
+       *
+       */
+      virtual void clear ();
+
+      /**Finds closest object which intersects with given ray
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param tmpDist temporary vector for calculations
+       * @param stats counters of intersection tests
+       * @return closest intersected object or nullptr if there's no intersection
+       */
+      virtual const VisibleObject *findIntersection (const Ray &ray,
+                                                     worldUnit &range,
+                                                     Vector &tmpDist,
+                                                     RenderStats &stats) const;
+
+      /**Finds closest objects which intersect with packet of rays
+       * Node is visited when any ray of the packet hits its bounds.
+       *
+       * @param packet rays to check intersection with
+       * @param hit closest intersections; ranges are shortened on hit
+       * @param stats counters of intersection tests
+       */
+      virtual void findIntersections (const RayPacket &packet,
+                                      PacketHit &hit,
+                                      RenderStats &stats) const;
+
+      /**Finds any object which intersects with given ray in given range
+       * Traversal stops at the first found intersection so it's
+       * suitable for shadow rays.
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray
+       * @param tmpDist temporary vector for calculations
+       * @param stats counters of intersection tests
+       * @return intersected object or nullptr if there's no intersection
+       */
+      virtual const VisibleObject *findAnyIntersection (const Ray &ray,
+                                                        worldUnit range,
+                                                        Vector &tmpDist,
+                                                        RenderStats &stats) const;
+
+      /**Returns true if tree has no objects
+       *
+       * @return is tree empty
+       */
+      inline virtual bool isEmpty () const
+      {
+        return objects.empty();
+      }
+
+      /**Returns memory allocated by nodes, objects and packed spheres
+       *
+       * @return size in bytes
+       */
+      virtual size_t getMemoryUsage () const;
+
+      /**Returns nodes of the tree
+       *
+       * @return nodes of the tree
+       */
+      inline const NodeContainer &getNodes () const
+      {
+        return nodes;
+      }
+
+      /**Returns objects ordered as referenced by leaves
+       *
+       * @return objects
+       */
+      inline const ObjectContainer &getObjects () const
+      {
+        return objects;
+      }
+
+    private:
+      struct BuildEntry;
+      typedef std::vector <BuildEntry> BuildContainer;
+
+      NodeContainer nodes;
+      ObjectContainer objects;
+
+      /**Surface area heuristic cost of the tree after build
+       *
+       */
+      worldUnit buildCost;
+
+      /**Packed copy of spheres from leaves
+       *
+       */
+      SphereStore sphereStore;
+
+      /**Splits node recursively until surface area heuristic says
+       * that leaf is cheaper than split
+       *
+       * @param nodeIdx index of node to subdivide
+       * @param entries bounds and centroids of objects in build order
+       * @param depth depth of the node in the tree
+       */
+      void subdivide (uint32_t nodeIdx, BuildContainer &entries, int depth);
+
+      /**Moves spheres to the beginning of each leaf and packs them
+       *
+       */
+      void packSpheres ();
+
+      /**Calculates surface area heuristic cost of the tree
+       * Cost is relative to surface area of the root, so it doesn't
+       * change when the whole scene is scaled.
+       *
+       * @return cost of the tree
+       */
+      worldUnit calculateCost () const;
+
+      /**Finds best split plane of node using binned surface area heuristic
+       *
+       * @param node node to split
+       * @param entries bounds and centroids of objects
+       * @param axis best split axis
+       * @param splitPosition best split position on axis
+       * @return cost of the best split
+       */
+      worldUnit findBestSplit (const Node &node,
+                               const BuildContainer &entries,
+                               int &axis,
+                               worldUnit &splitPosition) const;
+  };
+
+} /* namespace Model */
@@ -0,0 +1,183 @@
+/// @file Model/BoundingBox.h
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#include "Model/Point.h"
+#include "Model/Ray.h"
+#include "Model/Vector.h"
+
+namespace Model
+{
+
+  /**Axis aligned bounding box class
+   *
+   */
+  class BoundingBox
+  {
+    public:
+      /**Creates empty bounding box
+       *
+       */
+      inline BoundingBox ()
+      {
+        reset();
+      }
+
+      /**Creates bounding box with given corners
+       *
+       * @param newMin minimal corner
+       * @param newMax maximal corner
+       */
+      inline BoundingBox (const Point &newMin, const Point &newMax)
+          : min(newMin), max(newMax)
+      {
+      }
+
+      /**Makes bounding box empty
+       * Empty box can be extended by any point or box
+       *
+       */
+      inline void reset ()
+      {
+        const worldUnit limit = std::numeric_limits <worldUnit>::max();
+
+        min.set(limit, limit, limit);
+        max.set(-limit, -limit, -limit);
+      }
+
+      /**Extends bounding box to contain given point
+       *
+       * @param point point to contain
+       */
+      inline void extend (const Point &point)
+      {
+        min = min.min(point);
+        max = max.max(point);
+      }
+
+      /**Extends bounding box to contain other box
+       *
+       * @param other box to contain
+       */
+      inline void extend (const BoundingBox &other)
+      {
+        min = min.min(other.min);
+        max = max.max(other.max);
+      }
+
+      /**Returns minimal corner of the box
+       *
+       * @return minimal corner
+       */
+      inline const Point &getMin () const
+      {
+        return min;
+      }
+
+      /**Returns maximal corner of the box
+       *
+       * @return maximal corner
+       */
+      inline const Point &getMax () const
+      {
+        return max;
+      }
+
+      /**Returns center of the box
+       *
+       * @return center of the box
+       */
+      inline Point getCenter () const
+      {
+        return (min + max) * 0.5f;
+      }
+
+      /**Returns true if box doesn't contain any point
+       *
+       * @return is box empty
+       */
+      inline bool isEmpty () const
+      {
+        return min [X] > max [X] || min [Y] > max [Y] || min [Z] > max [Z];
+      }
+
+      /**Returns surface area of the box
+       * It is used by surface area heuristic
+       *
+       * @return surface area; 0 for empty box
+       */
+      inline worldUnit getSurfaceArea () const
+      {
+        if (isEmpty())
+        {
+          return 0;
+        }
+
+        Vector extent(max - min);
+
+        return 2.0f
+            * (extent [X] * extent [Y] + extent [Y] * extent [Z]
+                + extent [Z] * extent [X]);
+      }
+
+      /**Checks if ray intersects with box in range [0; range)
+       * Inverted ray direction has to be calculated by caller
+       * because it's shared between many boxes
+       *
+       * @param ray ray to check intersection with
+       * @param invDir inverted direction of ray
+       * @param range range of given ray
+       * @param distance distance to the box entry point; 0 if ray starts inside
+       * @return true if ray intersects with box in given range
+       */
+      inline bool checkRay (const Ray &ray,
+                            const Vector &invDir,
+                            worldUnit range,
+                            worldUnit &distance) const
+      {
+        SSEVector t1 = (min - ray.getStart()) * invDir;
+        SSEVector t2 = (max - ray.getStart()) * invDir;
+        SSEVector tNear = t1.min(t2);
+        SSEVector tFar = t1.max(t2);
+
+        worldUnit entry = std::max(std::max(tNear [X], tNear [Y]), tNear [Z]);
+        worldUnit exit = std::min(std::min(tFar [X], tFar [Y]), tFar [Z]);
+
+        distance = entry > 0.0f ? entry : 0.0f;
+
+        return entry <= exit && exit > 0.0f && distance < range;
+      }
+
+      /**Calculates inverted ray direction used by checkRay
+       * Zero components are replaced by very small values to avoid infinities
+       *
+       * @param direction ray direction
+       * @param invDir inverted direction
+       */
+      static inline void invertDirection (const Vector &direction,
+                                          Vector &invDir)
+      {
+        const worldUnit minComponent = 1e-20f;
+
+        for (int axis = Z; axis <= X; ++axis)
+        {
+          worldUnit component = direction [axis];
+
+          if (component > -minComponent && component < minComponent)
+          {
+            component = component < 0 ? -minComponent : minComponent;
+          }
+
+          invDir [axis] = 1.0f / component;
+        }
+      }
+
+    private:
+      Point min;
+      Point max;
+  };
+
+} /* namespace Model */
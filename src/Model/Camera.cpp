@@ -14,6 +14,7 @@ namespace Model
   Camera::Camera ()
   {
     screenImageRatio = 0;
+    focalLength = 0;
     imageWidth = 0;
     screenWidth = 0;
   }
@@ -24,7 +25,7 @@ namespace Model
 
     //Calculate focal length of camera
     worldUnit angle = (180 - FOV) / 2.0f;
-    worldUnit focalLength = tan(RAD(angle)) * screenWidth / 2;
+    focalLength = tan(RAD(angle)) * screenWidth / 2;
 
     //Calculate origin of camera
     eyeDirection.normalize();
@@ -58,6 +59,54 @@ namespace Model
     screenHeightDelta *= 1.0f / imageHeight;
   }
 
+  bool Camera::project (const Point &point,
+                        worldUnit &x,
+                        worldUnit &y,
+                        worldUnit &distance) const
+  {
+    Point onScreen;
+
+    if (type == Conic)
+    {
+      Vector toPoint = point - origin;
+      worldUnit along = toPoint.dotProduct(eyeDirection);
+
+      //Primary rays start on screen, so points before it aren't visible
+      if (along <= focalLength)
+      {
+        return false;
+      }
+
+      toPoint *= focalLength / along;
+      onScreen = origin.move(toPoint);
+    }
+    else
+    {
+      Vector toPoint = point - position;
+      worldUnit along = toPoint.dotProduct(eyeDirection);
+
+      if (along <= 0.0f)
+      {
+        return false;
+      }
+
+      onScreen = point.negMove(eyeDirection.multiply(along));
+    }
+
+    Vector toPoint = point - onScreen;
+    Vector onImage = onScreen - screenTopLeft;
+
+    toPoint.calculateLength();
+    distance = toPoint.length;
+
+    x = onImage.dotProduct(screenWidthDelta)
+        / screenWidthDelta.dotProduct();
+    y = onImage.dotProduct(screenHeightDelta)
+        / screenHeightDelta.dotProduct();
+
+    return true;
+  }
+
   void Camera::setType (const QString & typeName)
   {
     static cameraTypesMap cameraTypes;
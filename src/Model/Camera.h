@@ -65,6 +65,21 @@ namespace Model
         directionToPoint.normalize();
       }
 
+      /**Projects point in 3D space on the image
+       * Pixel (x, y) is the one whose primary ray starts at
+       * screenTopLeft + screenWidthDelta * x + screenHeightDelta * y.
+       *
+       * @param point point in 3D space
+       * @param x column of pixel; it isn't rounded
+       * @param y line of pixel; it isn't rounded
+       * @param distance distance from camera screen to the point
+       * @return false if point is behind camera screen
+       */
+      bool project (const Point &point,
+                    worldUnit &x,
+                    worldUnit &y,
+                    worldUnit &distance) const;
+
       /**Returns ratio of screen width to image width
        * "screenWidth/imageWidth"
        *
@@ -75,6 +90,22 @@ namespace Model
         return screenImageRatio;
       }
 
+      /**Returns approximated size of pixel at given distance from screen
+       * Pixels of conic camera grow with distance, orthogonal ones don't.
+       *
+       * @param distance distance from camera screen
+       * @return size of pixel in world units
+       */
+      inline worldUnit getPixelFootprint (worldUnit distance) const
+      {
+        if (type == Conic && focalLength > 0.0f)
+        {
+          return screenImageRatio * (1.0f + distance / focalLength);
+        }
+
+        return screenImageRatio;
+      }
+
       /**Returns top left corner of camera screen in 3D space
        *
        * @return top left corner of camera screen
@@ -134,7 +165,7 @@ namespace Model
        *
        * @return FOV
        */
-      inline unitType getFOV ()
+      inline unitType getFOV () const
       {
         return FOV;
       }
@@ -270,6 +301,7 @@ namespace Model
       worldUnit screenHeight;
       worldUnit screenWidth;
       worldUnit screenImageRatio;
+      worldUnit focalLength;
       worldUnit viewDistance;
       Type type;
   };
@@ -172,6 +172,16 @@ namespace Model
         return retColor(data [B]);
       }
 
+      /** Returns a component of the color without saturation
+       *
+       *  @param component component to return
+       *  @return value of component
+       */
+      inline dataType operator [] (ColorEnum component) const
+      {
+        return data [component];
+      }
+
     private:
       SSEVector data;
 
@@ -0,0 +1,723 @@
+/// @file Model/CompiledSceneFile.cpp
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <QByteArray>
+#include <QFile>
+
+#include "Model/CompiledSceneFile.h"
+#include "Model/LatticeSphere.h"
+#include "Model/Plane.h"
+#include "Model/Scene.h"
+#include "Model/Sphere.h"
+#include "Model/SphereStore.h"
+
+//Sections are aligned so records can be read in place from mapped file
+#define COMPILED_SCENE_ALIGNMENT 8
+
+//Written in native byte order, it reads differently on other machines
+#define COMPILED_SCENE_BYTE_ORDER 0x01020304u
+
+namespace Model
+{
+
+  namespace
+  {
+    const char COMPILED_SCENE_MAGIC [8] =
+      { 'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0' };
+
+    /**Position of array of records in file
+     *
+     */
+    struct Section
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    struct CameraRecord
+    {
+        double fov;
+        float position [3];
+        float angles [3];
+        float screenWidth;
+        float viewDistance;
+        uint32_t type;
+        uint32_t reserved;
+    };
+
+    struct FileHeader
+    {
+        char magic [8];
+        uint32_t version;
+        uint32_t byteOrder;
+        Section materials;
+        Section lights;
+        Section spheres;
+        Section lattices;
+        Section planes;
+        Section nodes;
+        Section bvhObjects;
+        Section strings;
+        CameraRecord camera;
+        /**Accelerators::AcceleratorType requested by scene
+         *
+         */
+        uint32_t accelerator;
+        uint32_t reserved;
+    };
+
+    /**Material; texture file name is UTF-8 text in strings section
+     *
+     */
+    struct MaterialRecord
+    {
+        float diffuse [3];
+        float specular [3];
+        float specularPower;
+        float reflection;
+        float transparency;
+        float ior;
+        uint32_t textureOffset;
+        uint32_t textureLength;
+    };
+
+    struct LightRecord
+    {
+        float position [3];
+        float color [3];
+        float power;
+    };
+
+    struct SphereRecord
+    {
+        float position [3];
+        float radius;
+        uint32_t material;
+    };
+
+    struct LatticeRecord
+    {
+        float position [3];
+        float radius;
+        float offset;
+        uint32_t counts [3];
+        uint32_t material;
+    };
+
+    /**Plane; angles [3] is distance of the plane from origin
+     *
+     */
+    struct PlaneRecord
+    {
+        float angles [4];
+        uint32_t material;
+    };
+
+    struct NodeRecord
+    {
+        float min [3];
+        float max [3];
+        uint32_t leftFirst;
+        uint32_t count;
+        uint32_t sphereCount;
+    };
+
+    /**Throws error about damaged file
+     *
+     */
+    void throwDamaged ()
+    {
+      throw std::logic_error("Uszkodzony plik skompilowanej sceny.");
+    }
+
+    /**Appends records to file data as a new aligned section
+     *
+     * @param data file data
+     * @param section position of the section
+     * @param records records to append
+     */
+    template <typename Record>
+    void appendSection (QByteArray &data,
+                        Section &section,
+                        const std::vector <Record> &records)
+    {
+      while (data.size() % COMPILED_SCENE_ALIGNMENT != 0)
+      {
+        data.append('\0');
+      }
+
+      section.offset = data.size();
+      section.count = records.size();
+
+      if (!records.empty())
+      {
+        data.append(reinterpret_cast <const char *>(records.data()),
+                    records.size() * sizeof(Record));
+      }
+    }
+
+    /**Returns records of section
+     * It checks that section lies inside the file.
+     *
+     * @param data file data
+     * @param size size of file data
+     * @param section position of the section
+     * @return first record of the section
+     */
+    template <typename Record>
+    const Record *getSection (const uchar *data,
+                              qint64 size,
+                              const Section &section)
+    {
+      if (section.offset % COMPILED_SCENE_ALIGNMENT != 0
+          || section.offset + static_cast <qint64>(section.count) * sizeof(Record)
+              > static_cast <quint64>(size))
+      {
+        throwDamaged();
+      }
+
+      return reinterpret_cast <const Record *>(data + section.offset);
+    }
+
+    /**Returns index of material in scene
+     *
+     * @param scene scene with materials
+     * @param material material of object
+     * @return index of material
+     */
+    uint32_t getMaterialIndex (const Scene &scene, const Material &material)
+    {
+      return &material - scene.getMaterials().data();
+    }
+
+    /**Checks that nodes form a tree which traversal can walk
+     * Every node except root has to be reached from root exactly once,
+     * so nodes can't be shared or unreachable. Depth of the tree is
+     * limited by size of traversal stack. Links were checked to stay
+     * inside the array before.
+     *
+     * @param nodes nodes of the tree; root is the first one
+     * @param count amount of nodes
+     */
+    void checkTree (const NodeRecord *nodes, uint32_t count)
+    {
+      struct Entry
+      {
+          uint32_t nodeIdx;
+          int depth;
+      };
+
+      std::vector <bool> reached(count, false);
+      std::vector <Entry> stack;
+      uint32_t reachedCount = 1;
+
+      reached [0] = true;
+      stack.push_back(Entry { 0, 0 });
+
+      while (!stack.empty())
+      {
+        Entry entry = stack.back();
+        const NodeRecord &node = nodes [entry.nodeIdx];
+
+        stack.pop_back();
+
+        if (entry.depth >= BVH_MAX_DEPTH)
+        {
+          throwDamaged();
+        }
+
+        if (node.count > 0)
+        {
+          continue;
+        }
+
+        for (uint32_t childIdx = node.leftFirst;
+            childIdx <= node.leftFirst + 1; ++childIdx)
+        {
+          if (reached [childIdx])
+          {
+            throwDamaged();
+          }
+
+          reached [childIdx] = true;
+          ++reachedCount;
+          stack.push_back(Entry { childIdx, entry.depth + 1 });
+        }
+      }
+
+      if (reachedCount != count)
+      {
+        throwDamaged();
+      }
+    }
+
+    /**Copies components of vector to array
+     *
+     */
+    void storeVector (const SSEVector &vector, float *data)
+    {
+      data [0] = vector [X];
+      data [1] = vector [Y];
+      data [2] = vector [Z];
+    }
+  }
+
+  bool CompiledSceneFile::isCompiledScene (QFile &file)
+  {
+    char magic [sizeof(COMPILED_SCENE_MAGIC)];
+    qint64 position = file.pos();
+    bool result = file.read(magic, sizeof(magic)) == sizeof(magic)
+        && std::memcmp(magic, COMPILED_SCENE_MAGIC, sizeof(magic)) == 0;
+
+    file.seek(position);
+
+    return result;
+  }
+
+  bool CompiledSceneFile::saveScene (const Scene &scene, QIODevice &io)
+  {
+    FileHeader header;
+    QByteArray strings;
+    std::vector <MaterialRecord> materials;
+    std::vector <LightRecord> lights;
+    std::vector <SphereRecord> spheres;
+    std::vector <LatticeRecord> lattices;
+    std::vector <PlaneRecord> planes;
+    std::vector <NodeRecord> nodes;
+    std::vector <uint32_t> bvhObjects;
+    std::unordered_map <const VisibleObject *, uint32_t> boundedIndices;
+
+    std::memset( &header, 0, sizeof(header));
+    std::memcpy(header.magic, COMPILED_SCENE_MAGIC, sizeof(header.magic));
+    header.version = COMPILED_SCENE_VERSION;
+    header.byteOrder = COMPILED_SCENE_BYTE_ORDER;
+
+    const Camera &camera = scene.getCamera();
+    header.camera.fov = camera.getFOV();
+    storeVector(camera.getPosition(), header.camera.position);
+    storeVector(camera.getAngles(), header.camera.angles);
+    header.camera.screenWidth = camera.getScreenWidth();
+    header.camera.viewDistance = camera.getViewDistance();
+    header.camera.type = camera.getType();
+    header.accelerator = scene.getAcceleratorType();
+
+    for (const Material &material : scene.getMaterials())
+    {
+      MaterialRecord record;
+      QByteArray texture = material.getTextureFileName().toUtf8();
+
+      storeVector(SSEVector(material.getColor() [Color::R],
+                            material.getColor() [Color::G],
+                            material.getColor() [Color::B]),
+                  record.diffuse);
+      storeVector(SSEVector(material.getSpecularColor() [Color::R],
+                            material.getSpecularColor() [Color::G],
+                            material.getSpecularColor() [Color::B]),
+                  record.specular);
+      record.specularPower = material.getSpecularPower();
+      record.reflection = material.getReflection();
+      record.transparency = material.getTransparency();
+      record.ior = material.getIOR();
+      record.textureOffset = strings.size();
+      record.textureLength = texture.size();
+      strings.append(texture);
+
+      materials.push_back(record);
+    }
+
+    for (const Light &light : scene.getLights())
+    {
+      LightRecord record;
+
+      storeVector(light.getPosition(), record.position);
+      storeVector(SSEVector(light [Color::R], light [Color::G],
+                            light [Color::B]),
+                  record.color);
+      record.power = light.power;
+
+      lights.push_back(record);
+    }
+
+    for (const VisibleObjectUniquePtr &object : scene.getObjects())
+    {
+      if (const Sphere *sphere = dynamic_cast <const Sphere *>(object.get()))
+      {
+        SphereRecord record;
+
+        storeVector(sphere->getPosition(), record.position);
+        record.radius = sphere->getSize();
+        record.material = getMaterialIndex(scene, sphere->getMaterial());
+
+        boundedIndices [sphere] = spheres.size();
+        spheres.push_back(record);
+      }
+      else if (const LatticeSphere *lattice =
+          dynamic_cast <const LatticeSphere *>(object.get()))
+      {
+        LatticeRecord record;
+
+        storeVector(lattice->getPosition(), record.position);
+        record.radius = lattice->getSize();
+        record.offset = lattice->getOffset();
+        record.counts [0] = lattice->getCount(X);
+        record.counts [1] = lattice->getCount(Y);
+        record.counts [2] = lattice->getCount(Z);
+        record.material = getMaterialIndex(scene, lattice->getMaterial());
+
+        //Index is moved behind spheres when the whole file is known
+        boundedIndices [lattice] = lattices.size();
+        lattices.push_back(record);
+      }
+      else if (const Plane *plane = dynamic_cast <const Plane *>(object.get()))
+      {
+        PlaneRecord record;
+
+        storeVector(plane->getAngles(), record.angles);
+        record.angles [3] = plane->getAngles().length;
+        record.material = getMaterialIndex(scene, plane->getMaterial());
+
+        planes.push_back(record);
+      }
+      else
+      {
+        throw std::logic_error(
+            "Scena zawiera obiekty, których nie można skompilować.");
+      }
+    }
+
+    //Only BVH is stored, tree is built when scene uses other structure
+    //and it's used on load when the scene doesn't ask for grid
+    BVH builtBVH;
+    const BVH *storedBVH = dynamic_cast <const BVH *>( &scene
+        .getAccelerationStructure());
+
+    if (storedBVH == nullptr)
+    {
+      BVH::ObjectContainer boundedObjects;
+      BoundingBox box;
+
+      for (const VisibleObjectUniquePtr &object : scene.getObjects())
+      {
+        if (object->getBoundingBox(box))
+        {
+          boundedObjects.push_back(object.get());
+        }
+      }
+
+      builtBVH.build(boundedObjects);
+      storedBVH = &builtBVH;
+    }
+
+    const BVH &bvh = *storedBVH;
+
+    for (const BVH::Node &node : bvh.getNodes())
+    {
+      NodeRecord record;
+
+      storeVector(node.bounds.getMin(), record.min);
+      storeVector(node.bounds.getMax(), record.max);
+      record.leftFirst = node.leftFirst;
+      record.count = node.count;
+      record.sphereCount = node.sphereCount;
+
+      nodes.push_back(record);
+    }
+
+    //Bounded objects are indexed as spheres followed by lattices
+    for (const VisibleObject *object : bvh.getObjects())
+    {
+      uint32_t index = boundedIndices.at(object);
+
+      if (!SphereStore::isSphere(object))
+      {
+        index += spheres.size();
+      }
+
+      bvhObjects.push_back(index);
+    }
+
+    QByteArray data(sizeof(header), '\0');
+
+    appendSection(data, header.materials, materials);
+    appendSection(data, header.lights, lights);
+    appendSection(data, header.spheres, spheres);
+    appendSection(data, header.lattices, lattices);
+    appendSection(data, header.planes, planes);
+    appendSection(data, header.nodes, nodes);
+    appendSection(data, header.bvhObjects, bvhObjects);
+    appendSection(data, header.strings,
+                  std::vector <char>(strings.begin(), strings.end()));
+
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    return io.write(data) == data.size();
+  }
+
+  void CompiledSceneFile::loadScene (QFile &file, Scene &scene)
+  {
+    qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    QByteArray buffer;
+
+    //Mapping isn't supported by every device, then file is read instead
+    if (data == nullptr)
+    {
+      buffer = file.readAll();
+      data = reinterpret_cast <uchar *>(buffer.data());
+      size = buffer.size();
+    }
+
+    FileHeader header;
+
+    if (size < static_cast <qint64>(sizeof(header)))
+    {
+      throwDamaged();
+    }
+
+    std::memcpy( &header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, COMPILED_SCENE_MAGIC, sizeof(header.magic))
+        != 0 || header.byteOrder != COMPILED_SCENE_BYTE_ORDER)
+    {
+      throwDamaged();
+    }
+
+    if (header.version != COMPILED_SCENE_VERSION)
+    {
+      throw std::logic_error(
+          "Nieobsługiwana wersja pliku skompilowanej sceny. Skompiluj scenę ponownie.");
+    }
+
+    const MaterialRecord *materials = getSection <MaterialRecord>(
+        data, size, header.materials);
+    const LightRecord *lights = getSection <LightRecord>(data, size,
+                                                         header.lights);
+    const SphereRecord *spheres = getSection <SphereRecord>(data, size,
+                                                            header.spheres);
+    const LatticeRecord *lattices = getSection <LatticeRecord>(
+        data, size, header.lattices);
+    const PlaneRecord *planes = getSection <PlaneRecord>(data, size,
+                                                         header.planes);
+    const NodeRecord *nodes = getSection <NodeRecord>(data, size,
+                                                      header.nodes);
+    const uint32_t *bvhObjects = getSection <uint32_t>(data, size,
+                                                       header.bvhObjects);
+    const char *strings = getSection <char>(data, size, header.strings);
+
+    if (header.materials.count == 0)
+      throw std::logic_error("Brak zdefiniowanych materiałów");
+
+    if (header.lights.count == 0)
+      throw std::logic_error("Brak świateł w scenie");
+
+    for (uint32_t i = 0; i < header.materials.count; ++i)
+    {
+      const MaterialRecord &record = materials [i];
+      Material material;
+
+      //Values are checked the same way as in XML scene
+      if (static_cast <quint64>(record.textureOffset) + record.textureLength
+          > header.strings.count
+          || ! (record.reflection >= 0.0f && record.reflection <= 1.0f)
+          || ! (record.ior >= 1.0f)
+          || ! (record.transparency >= 0.0f && record.transparency <= 1.0f)
+          || ! (record.specularPower >= 0.0f))
+      {
+        throwDamaged();
+      }
+
+      material.setColor(
+          Color(record.diffuse [0], record.diffuse [1], record.diffuse [2]));
+      material.setSpecularColor(
+          Color(record.specular [0], record.specular [1], record.specular [2]));
+      material.setSpecularPower(record.specularPower);
+      material.setReflection(record.reflection);
+      material.setTransparency(record.transparency);
+      material.setIOR(record.ior);
+      material.setTexture(
+          QString::fromUtf8(strings + record.textureOffset,
+                            record.textureLength));
+
+      scene.addMaterial(std::move(material));
+    }
+
+    for (uint32_t i = 0; i < header.lights.count; ++i)
+    {
+      const LightRecord &record = lights [i];
+      Point position(record.position [0], record.position [1],
+                     record.position [2]);
+      Color color(record.color [0], record.color [1], record.color [2]);
+
+      if (! (record.power >= 0.0f))
+      {
+        throwDamaged();
+      }
+
+      scene.addLight(Light(position, color, record.power));
+    }
+
+    //Materials won't move anymore, objects can point to them
+    const Material *sceneMaterials = scene.getMaterials().data();
+    Scene::ObjectPtrContainer boundedObjects;
+
+    boundedObjects.reserve(header.spheres.count + header.lattices.count);
+
+    for (uint32_t i = 0; i < header.spheres.count; ++i)
+    {
+      const SphereRecord &record = spheres [i];
+
+      if (record.material >= header.materials.count
+          || ! (record.radius > 0.0f))
+      {
+        throwDamaged();
+      }
+
+      std::unique_ptr <VisibleObject> object(new Sphere(record.radius));
+
+      object->setPosition(record.position [0], record.position [1],
+                          record.position [2]);
+      object->setMaterial(sceneMaterials + record.material);
+
+      boundedObjects.push_back(object.get());
+      scene.addVisibleObject(std::move(object));
+    }
+
+    for (uint32_t i = 0; i < header.lattices.count; ++i)
+    {
+      const LatticeRecord &record = lattices [i];
+
+      if (record.material >= header.materials.count
+          || ! (record.radius > 0.0f) || ! (record.offset > 0.0f)
+          || ! (static_cast <int>(record.counts [0]) > 0)
+          || ! (static_cast <int>(record.counts [1]) > 0)
+          || ! (static_cast <int>(record.counts [2]) > 0))
+      {
+        throwDamaged();
+      }
+
+      std::unique_ptr <VisibleObject> object(
+          new LatticeSphere(record.radius, record.offset, record.counts [0],
+                            record.counts [1], record.counts [2]));
+
+      object->setPosition(record.position [0], record.position [1],
+                          record.position [2]);
+      object->setMaterial(sceneMaterials + record.material);
+
+      boundedObjects.push_back(object.get());
+      scene.addVisibleObject(std::move(object));
+    }
+
+    for (uint32_t i = 0; i < header.planes.count; ++i)
+    {
+      const PlaneRecord &record = planes [i];
+      std::unique_ptr <Plane> object(new Plane());
+      Vector angles(record.angles [0], record.angles [1], record.angles [2]);
+
+      if (record.material >= header.materials.count)
+      {
+        throwDamaged();
+      }
+
+      angles.length = record.angles [3];
+      object->setAngles(angles);
+      object->setMaterial(sceneMaterials + record.material);
+
+      scene.addVisibleObject(std::move(object));
+    }
+
+    Camera camera;
+
+    if (header.accelerator > Accelerators::Grid)
+    {
+      throwDamaged();
+    }
+
+    scene.setAcceleratorType(
+        static_cast <Accelerators::AcceleratorType>(header.accelerator));
+
+    if (header.camera.type > Camera::Conic
+        || ! (header.camera.fov > 0 && header.camera.fov < MAX_VIEW_ANGLE)
+        || ! (header.camera.screenWidth > 0.0f)
+        || ! (header.camera.viewDistance > 0.0f))
+    {
+      throwDamaged();
+    }
+
+    camera.setFOV(header.camera.fov);
+    camera.setViewDistance(header.camera.viewDistance);
+    camera.setScreenWidth(header.camera.screenWidth);
+    camera.setPosition(header.camera.position [0], header.camera.position [1],
+                       header.camera.position [2]);
+    camera.setAngles(
+        Vector(header.camera.angles [0], header.camera.angles [1],
+               header.camera.angles [2]));
+    camera.setType(static_cast <Camera::Type>(header.camera.type));
+
+    scene.setCamera(camera);
+
+    //All bounded objects are in BVH; links of nodes are checked so
+    //traversal can't leave the arrays, loop or overflow its stack
+    if (header.bvhObjects.count != boundedObjects.size()
+        || (header.nodes.count == 0) != boundedObjects.empty())
+    {
+      throwDamaged();
+    }
+
+    BVH::NodeContainer bvhNodes(header.nodes.count);
+    Scene::ObjectPtrContainer bvhObjectPtrs(header.bvhObjects.count);
+
+    for (uint32_t i = 0; i < header.nodes.count; ++i)
+    {
+      const NodeRecord &record = nodes [i];
+      BVH::Node &node = bvhNodes [i];
+
+      if (record.count > 0)
+      {
+        if (static_cast <quint64>(record.leftFirst) + record.count
+            > header.bvhObjects.count || record.sphereCount > record.count)
+        {
+          throwDamaged();
+        }
+      }
+      else if (record.leftFirst <= i
+          || static_cast <quint64>(record.leftFirst) + 1 >= header.nodes.count)
+      {
+        throwDamaged();
+      }
+
+      node.bounds = BoundingBox(
+          Point(record.min [0], record.min [1], record.min [2]),
+          Point(record.max [0], record.max [1], record.max [2]));
+      node.leftFirst = record.leftFirst;
+      node.count = record.count;
+      node.sphereCount = record.sphereCount;
+    }
+
+    for (uint32_t i = 0; i < header.bvhObjects.count; ++i)
+    {
+      if (bvhObjects [i] >= boundedObjects.size())
+      {
+        throwDamaged();
+      }
+
+      bvhObjectPtrs [i] = boundedObjects [bvhObjects [i]];
+    }
+
+    if (header.nodes.count > 0)
+    {
+      checkTree(nodes, header.nodes.count);
+    }
+
+    scene.restoreAccelerationStructure(std::move(bvhNodes), bvhObjectPtrs);
+
+    if (buffer.isNull())
+    {
+      file.unmap(data);
+    }
+  }
+
+} /* namespace Model */
@@ -0,0 +1,60 @@
+/// @file Model/CompiledSceneFile.h
+
+#pragma once
+
+#include "Controller/GlobalDefines.h"
+
+//Version of compiled scene format; files with other version are rejected
+#define COMPILED_SCENE_VERSION 3
+
+class QFile;
+class QIODevice;
+
+namespace Model
+{
+  //Forward declarations -->
+  class Scene;
+  // <-- Forward declarations
+
+  /**Compiled scene file
+   * Binary scene format with flat arrays of materials, lights, spheres,
+   * lattices of spheres, planes and nodes of prebuilt BVH. File is mapped
+   * into memory and objects are created straight from records, so no text
+   * is parsed and BVH isn't built again. Type of acceleration structure
+   * is kept; grid is built on load when scene asks for it.
+   * Records are written in native byte order; file written on machine
+   * with other byte order is rejected.
+   *
+   */
+  class CompiledSceneFile
+  {
+    public:
+      /**Checks if file starts with compiled scene signature
+       * Position in file is restored.
+       *
+       * @param file opened file
+       * @return true if file is compiled scene
+       */
+      static bool isCompiledScene (QFile &file);
+
+      /**Writes loaded scene to compiled scene file
+       * It throws std::logic_error when scene has objects which
+       * can't be compiled.
+       *
+       * @param scene scene with built acceleration structure
+       * @param io device to write data to
+       * @return false if data couldn't be written
+       */
+      static bool saveScene (const Scene &scene, QIODevice &io);
+
+      /**Loads scene from compiled scene file
+       * It throws std::logic_error when file is damaged
+       * or has unsupported version.
+       *
+       * @param file opened file
+       * @param scene empty scene to load data in
+       */
+      static void loadScene (QFile &file, Scene &scene);
+  };
+
+} /* namespace Model */
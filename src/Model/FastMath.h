@@ -0,0 +1,202 @@
+/// @file Model/FastMath.h
+
+#pragma once
+
+#include <cmath>
+
+#include "Model/ModelDefines.h"
+#include "Model/RayPacket.h"
+#include "Model/SSEData.h"
+
+//Maximal absolute errors [rad] of approximations, checked by Benchmark --check
+#define FAST_ACOS_MAX_ERROR 1e-4f
+#define FAST_ATAN2_MAX_ERROR 1e-5f
+
+namespace Model
+{
+
+  /**Approximated math for texture mapping
+   * Results are good enough for 8-bit texels and much cheaper than libm.
+   * Every function has scalar version and packet version which
+   * evaluates PACKET_SIZE arguments at once.
+   *
+   */
+  namespace FastMath
+  {
+    //Coefficients of acos(x) ~ sqrt(1 - x) * P(x) for 0 <= x <= 1
+    //(Abramowitz & Stegun 4.4.45)
+    const float ACOS_C0 = 1.5707288f;
+    const float ACOS_C1 = -0.2121144f;
+    const float ACOS_C2 = 0.0742610f;
+    const float ACOS_C3 = -0.0187293f;
+
+    //Coefficients of odd polynomial atan(z) for 0 <= z <= 1
+    const float ATAN_C1 = 0.99997726f;
+    const float ATAN_C3 = -0.33262347f;
+    const float ATAN_C5 = 0.19354346f;
+    const float ATAN_C7 = -0.11643287f;
+    const float ATAN_C9 = 0.05265332f;
+    const float ATAN_C11 = -0.01172120f;
+
+    /**Approximated arc cosine
+     *
+     * @param x cosine; it's clamped to [-1; 1]
+     * @return angle in range [0; PI]
+     */
+    inline float acos (float x)
+    {
+      float ax = std::fabs(x);
+
+      if (ax > 1.0f)
+      {
+        ax = 1.0f;
+      }
+
+      float result = std::sqrt(1.0f - ax)
+          * (ACOS_C0 + ax * (ACOS_C1 + ax * (ACOS_C2 + ax * ACOS_C3)));
+
+      return x < 0.0f ? PI - result : result;
+    }
+
+    /**Approximated arc tangent of y/x using signs of both arguments
+     *
+     * @param y
+     * @param x
+     * @return angle in range [-PI; PI]; 0 if both arguments are 0
+     */
+    inline float atan2 (float y, float x)
+    {
+      float ax = std::fabs(x);
+      float ay = std::fabs(y);
+      float maxValue = ax > ay ? ax : ay;
+      float minValue = ax > ay ? ay : ax;
+
+      if (maxValue <= 0.0f)
+      {
+        return 0.0f;
+      }
+
+      float z = minValue / maxValue;
+      float z2 = z * z;
+      float result = z
+          * (ATAN_C1
+              + z2
+                  * (ATAN_C3
+                      + z2
+                          * (ATAN_C5
+                              + z2 * (ATAN_C7 + z2 * (ATAN_C9 + z2 * ATAN_C11)))));
+
+      //Reduction to [0; 1] is reverted octant by octant
+      if (ay > ax)
+      {
+        result = 0.5f * PI - result;
+      }
+
+      if (x < 0.0f)
+      {
+        result = PI - result;
+      }
+
+      return y < 0.0f ? -result : result;
+    }
+
+    /**Calculates spherical texture coordinates of unit normal
+     * It's the same mapping as in Material::getTextureColor,
+     * acos(x / sin(acos(y))) is replaced by equal atan2(|z|, x).
+     *
+     * @param normal unit normal vector
+     * @param u horizontal coordinate in range [0; 0.5]
+     * @param v vertical coordinate in range [0; 1]
+     */
+    inline void sphericalUV (const SSEVector &normal, float &u, float &v)
+    {
+      v = acos(normal [Y]) * (1.0f / PI);
+      u = atan2(std::fabs(normal [Z]), normal [X]) * (0.5f / PI);
+    }
+
+    /**Absolute value of packet
+     *
+     */
+    inline PacketFloat packetAbs (const PacketFloat &x)
+    {
+      return packetMax(x, packetSub(packetSet(0.0f), x));
+    }
+
+    /**Approximated arc cosine of PACKET_SIZE values
+     *
+     * @param x cosines; they're clamped to [-1; 1]
+     * @return angles in range [0; PI]
+     */
+    inline PacketFloat packetAcos (const PacketFloat &x)
+    {
+      PacketFloat ax = packetMin(packetAbs(x), packetSet(1.0f));
+      PacketFloat poly = packetAdd(packetSet(ACOS_C2),
+                                   packetMul(ax, packetSet(ACOS_C3)));
+      poly = packetAdd(packetSet(ACOS_C1), packetMul(ax, poly));
+      poly = packetAdd(packetSet(ACOS_C0), packetMul(ax, poly));
+
+      PacketFloat result = packetMul(
+          packetSqrt(packetSub(packetSet(1.0f), ax)), poly);
+
+      return packetSelect(result, packetSub(packetSet(PI), result),
+                          packetLess(x, packetSet(0.0f)));
+    }
+
+    /**Approximated arc tangent of PACKET_SIZE values of y/x
+     *
+     * @param y
+     * @param x
+     * @return angles in range [-PI; PI]; 0 where both arguments are 0
+     */
+    inline PacketFloat packetAtan2 (const PacketFloat &y, const PacketFloat &x)
+    {
+      const PacketFloat zero = packetSet(0.0f);
+      PacketFloat ax = packetAbs(x);
+      PacketFloat ay = packetAbs(y);
+      PacketFloat maxValue = packetMax(ax, ay);
+      PacketFloat minValue = packetMin(ax, ay);
+
+      //Division by 0 is avoided, 0 / 1 gives 0
+      PacketFloat isZero = packetLessEqual(maxValue, zero);
+      PacketFloat z = packetDiv(
+          minValue, packetSelect(maxValue, packetSet(1.0f), isZero));
+      PacketFloat z2 = packetMul(z, z);
+
+      PacketFloat poly = packetAdd(packetSet(ATAN_C9),
+                                   packetMul(z2, packetSet(ATAN_C11)));
+      poly = packetAdd(packetSet(ATAN_C7), packetMul(z2, poly));
+      poly = packetAdd(packetSet(ATAN_C5), packetMul(z2, poly));
+      poly = packetAdd(packetSet(ATAN_C3), packetMul(z2, poly));
+      poly = packetAdd(packetSet(ATAN_C1), packetMul(z2, poly));
+
+      PacketFloat result = packetMul(z, poly);
+
+      result = packetSelect(result, packetSub(packetSet(0.5f * PI), result),
+                            packetLess(ax, ay));
+      result = packetSelect(result, packetSub(packetSet(PI), result),
+                            packetLess(x, zero));
+
+      return packetSelect(result, packetSub(zero, result), packetLess(y, zero));
+    }
+
+    /**Calculates spherical texture coordinates of PACKET_SIZE unit normals
+     *
+     * @param x X components of normals
+     * @param y Y components of normals
+     * @param z Z components of normals
+     * @param u horizontal coordinates in range [0; 0.5]
+     * @param v vertical coordinates in range [0; 1]
+     */
+    inline void packetSphericalUV (const PacketFloat &x,
+                                   const PacketFloat &y,
+                                   const PacketFloat &z,
+                                   PacketFloat &u,
+                                   PacketFloat &v)
+    {
+      v = packetMul(packetAcos(y), packetSet(1.0f / PI));
+      u = packetMul(packetAtan2(packetAbs(z), x), packetSet(0.5f / PI));
+    }
+
+  } /* namespace FastMath */
+
+} /* namespace Model */
@@ -0,0 +1,147 @@
+/// @file Model/GroupInstance.cpp
+
+#include <limits>
+
+#include "Model/BoundingBox.h"
+#include "Model/GroupInstance.h"
+#include "Model/Ray.h"
+#include "Model/RenderStats.h"
+
+namespace Model
+{
+
+  GroupInstance::GroupInstance (const ObjectGroupSharedPtr &newGroup)
+      : group(newGroup)
+  {
+    setTransform(Vector(0, 0, 0), 1.0f);
+  }
+
+  void GroupInstance::setTransform (const Vector &newAngles, worldUnit newScale)
+  {
+    angles = newAngles;
+    scale = newScale;
+    invScale = 1.0f / newScale;
+
+    axes [0].set(1, 0, 0);
+    axes [1].set(0, 1, 0);
+    axes [2].set(0, 0, 1);
+
+    for (Vector &axis : axes)
+    {
+      axis.rotate(angles);
+    }
+  }
+
+  void GroupInstance::getNormal (const Point& point, Vector &normalAtPoint) const
+  {
+    Point center(toGroupSpace(point).diff(group->getBounds().getCenter()));
+
+    normalAtPoint = toSceneDirection(Vector(center [X], center [Y], center [Z]));
+    normalAtPoint.normalize();
+  }
+
+  bool GroupInstance::getBoundingBox (BoundingBox &box) const
+  {
+    const BoundingBox &bounds = group->getBounds();
+    const Point &min = bounds.getMin();
+    const Point &max = bounds.getMax();
+
+    box.reset();
+
+    //Box of rotated group has to contain all its corners
+    for (int corner = 0; corner < 8; ++corner)
+    {
+      Vector offset( (corner & 1) ? max [X] : min [X],
+                    (corner & 2) ? max [Y] : min [Y],
+                    (corner & 4) ? max [Z] : min [Z]);
+
+      box.extend(position.move(toSceneDirection(offset) * scale));
+    }
+
+    return true;
+  }
+
+  bool GroupInstance::checkRay (const Ray &ray,
+                                worldUnit &range,
+                                Vector &tmpDist) const
+  {
+    //Counters of group objects aren't summed with counters of renderer
+    RenderStats stats;
+    Ray groupRay(toGroupSpace(ray.getStart()), toGroupDirection(ray.getDir()));
+    worldUnit groupRange = range * invScale;
+
+    if (group->getBVH().findIntersection(groupRay, groupRange, tmpDist, stats)
+        == nullptr)
+    {
+      return false;
+    }
+
+    range = groupRange * scale;
+
+    return true;
+  }
+
+  const VisibleObject &GroupInstance::getHitSurface (const Ray &ray,
+                                                     worldUnit distance,
+                                                     const Point &point,
+                                                     Vector &normalAtPoint,
+                                                     worldUnit &size) const
+  {
+    RenderStats stats;
+    Vector tmpDist;
+    Ray groupRay(toGroupSpace(ray.getStart()), toGroupDirection(ray.getDir()));
+    Point groupPoint(toGroupSpace(point));
+    Vector groupNormal;
+
+    //Hit is found again, range is a bit longer because of rounding errors
+    worldUnit groupRange = distance * invScale * (1.0f + FLOAT_EPSILON)
+        + FLOAT_EPSILON;
+    const VisibleObject *object = group->getBVH().findIntersection(
+        groupRay, groupRange, tmpDist, stats);
+
+    if (object == nullptr)
+    {
+      groupRange = std::numeric_limits <worldUnit>::max();
+      object = group->getBVH().findIntersection(groupRay, groupRange, tmpDist,
+                                                stats);
+    }
+
+    if (object == nullptr)
+    {
+      object = group->getObjects().front().get();
+    }
+
+    const VisibleObject &surface = object->getHitSurface(groupRay, groupRange,
+                                                         groupPoint,
+                                                         groupNormal, size);
+
+    normalAtPoint = toSceneDirection(groupNormal);
+    normalAtPoint.normalize();
+    size *= scale;
+
+    return surface;
+  }
+
+  Point GroupInstance::toGroupSpace (const Point &point) const
+  {
+    Vector offset(point.diff(position));
+
+    return Point(offset.dotProduct(axes [0]) * invScale,
+                 offset.dotProduct(axes [1]) * invScale,
+                 offset.dotProduct(axes [2]) * invScale);
+  }
+
+  Vector GroupInstance::toGroupDirection (const Vector &direction) const
+  {
+    return Vector(direction.dotProduct(axes [0]),
+                  direction.dotProduct(axes [1]),
+                  direction.dotProduct(axes [2]));
+  }
+
+  Vector GroupInstance::toSceneDirection (const Vector &direction) const
+  {
+    return axes [0] * direction [X] + axes [1] * direction [Y]
+        + axes [2] * direction [Z];
+  }
+
+} /* namespace Model */
@@ -0,0 +1,141 @@
+/// @file Model/GroupInstance.h
+
+#pragma once
+
+#include "Model/ObjectGroup.h"
+#include "Model/VisibleObject.h"
+
+namespace Model
+{
+
+  /**Placement of object group in scene
+   * Instance keeps only transform (position, rotation and uniform
+   * scale) and shared pointer to the group. Rays are moved into group
+   * space and checked against BVH of the group, so the scene BVH is
+   * the top level structure over instances. Moving instance doesn't
+   * touch the group.
+   *
+   */
+  class GroupInstance: public VisibleObject
+  {
+    public:
+      /**Creates instance of group without rotation and scale
+       *
+       * @param newGroup built group
+       */
+      GroupInstance (const ObjectGroupSharedPtr &newGroup);
+
+      inline virtual ~GroupInstance ()
+      {
+      }
+
+      /**Sets rotation and scale of the instance
+       * Position is set with setPosition.
+       *
+       * @param newAngles rotation angles in degrees, like in Plane
+       * @param newScale uniform scale; it has to be > 0
+       */
+      void setTransform (const Vector &newAngles, worldUnit newScale);
+
+      /**Returns rotation angles
+       *
+       * @return angles in degrees
+       */
+      inline const Vector &getAngles () const
+      {
+        return angles;
+      }
+
+      /**Returns uniform scale
+       *
+       * @return scale
+       */
+      inline worldUnit getScale () const
+      {
+        return scale;
+      }
+
+      /**Returns instanced group
+       *
+       * @return group
+       */
+      inline const ObjectGroupSharedPtr &getGroup () const
+      {
+        return group;
+      }
+
+      /**Approximates normal by direction from center of the group
+       * Exact normal is calculated by getHitSurface.
+       *
+       * @param point point to calculate normal at
+       * @param normalAtPoint vector to calculate normal in
+       */
+      virtual void getNormal (const Point& point, Vector &normalAtPoint) const;
+
+      /**Calculates bounding box of transformed group
+       *
+       * @param box box to calculate bounds in
+       * @return always true
+       */
+      virtual bool getBoundingBox (BoundingBox &box) const;
+
+      /**Checks if given ray intersects with any object of the group
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param tmpDist temporary vector for calculations
+       * @return true if ray intersects with the group in its range
+       */
+      virtual bool checkRay (const Ray &ray,
+                             worldUnit &range,
+                             Vector &tmpDist) const;
+
+      /**Finds hit object of the group and its normal in scene space
+       *
+       * @param ray ray which hit the instance
+       * @param distance distance to the intersection
+       * @param point intersection point
+       * @param normalAtPoint vector to calculate normal in
+       * @param size size of hit object scaled by the instance
+       * @return hit object of the group
+       */
+      virtual const VisibleObject &getHitSurface (const Ray &ray,
+                                                  worldUnit distance,
+                                                  const Point &point,
+                                                  Vector &normalAtPoint,
+                                                  worldUnit &size) const;
+
+    private:
+      ObjectGroupSharedPtr group;
+      Vector angles;
+      worldUnit scale;
+      worldUnit invScale;
+
+      /**Rotated X, Y and Z axes of the group in scene space
+       *
+       */
+      Vector axes [3];
+
+      /**Moves point from scene space to group space
+       *
+       * @param point point in scene space
+       * @return point in group space
+       */
+      Point toGroupSpace (const Point &point) const;
+
+      /**Rotates direction from scene space to group space
+       *
+       * @param direction direction in scene space
+       * @return direction in group space
+       */
+      Vector toGroupDirection (const Vector &direction) const;
+
+      /**Rotates direction from group space to scene space
+       *
+       * @param direction direction in group space
+       * @return direction in scene space
+       */
+      Vector toSceneDirection (const Vector &direction) const;
+  };
+
+} /* namespace Model */
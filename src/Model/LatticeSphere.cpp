@@ -0,0 +1,197 @@
+/// @file Model/LatticeSphere.cpp
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Model/BoundingBox.h"
+#include "Model/LatticeSphere.h"
+#include "Model/Ray.h"
+#include "Model/Sphere.h"
+
+namespace Model
+{
+
+  namespace
+  {
+    const Axis LATTICE_AXES [3] =
+      { X, Y, Z };
+  }
+
+  LatticeSphere::LatticeSphere (worldUnit radius,
+                                worldUnit newOffset,
+                                int countX,
+                                int countY,
+                                int countZ)
+      : squareRadius(radius * radius), offset(newOffset), invOffset(
+          1.0f / newOffset)
+  {
+    size = radius;
+    counts [0] = countX;
+    counts [1] = countY;
+    counts [2] = countZ;
+
+    //Sphere of cell c reaches cells up to c +- (radius / offset - 0.5)
+    reach = std::max(0, static_cast <int>(std::ceil(radius * invOffset - 0.5f)));
+  }
+
+  void LatticeSphere::getNormal (const Point& point, Vector &normalAtPoint) const
+  {
+    Point center(position);
+
+    //Hit point lies on the surface of the closest sphere
+    for (int i = 0; i < 3; ++i)
+    {
+      Axis axis = LATTICE_AXES [i];
+      int idx = static_cast <int>(std::floor(
+          (point [axis] - position [axis]) * invOffset + 0.5f));
+
+      idx = std::min(std::max(idx, 0), counts [i] - 1);
+      center [axis] += idx * offset;
+    }
+
+    normalAtPoint = point.diff(center);
+    normalAtPoint.normalize();
+  }
+
+  bool LatticeSphere::getBoundingBox (BoundingBox &box) const
+  {
+    Point extent(size, size, size);
+    Point last(position);
+
+    for (int i = 0; i < 3; ++i)
+    {
+      last [LATTICE_AXES [i]] += (counts [i] - 1) * offset;
+    }
+
+    box = BoundingBox(position - extent, last + extent);
+
+    return true;
+  }
+
+  bool LatticeSphere::checkRay (const Ray &ray,
+                                worldUnit &range,
+                                Vector &tmpDist) const
+  {
+    BoundingBox box;
+    Vector invDir;
+    worldUnit distance;
+
+    getBoundingBox(box);
+    BoundingBox::invertDirection(ray.getDir(), invDir);
+
+    if (!box.checkRay(ray, invDir, range, distance))
+    {
+      return false;
+    }
+
+    int cell [3];
+    int step [3];
+    worldUnit next [3];
+    worldUnit delta [3];
+
+    //Cell c spans (c - 0.5; c + 0.5) * offset around center of sphere c
+    //Cells outside of lattice are visited when spheres stick out of it
+    for (int i = 0; i < 3; ++i)
+    {
+      Axis axis = LATTICE_AXES [i];
+      worldUnit start = ray.getStart() [axis];
+      worldUnit dir = ray.getDir() [axis];
+      worldUnit local = (start + dir * distance - position [axis]) * invOffset;
+
+      cell [i] = static_cast <int>(std::floor(local + 0.5f));
+      cell [i] = std::min(std::max(cell [i], -reach), counts [i] - 1 + reach);
+
+      if (dir > 0.0f)
+      {
+        step [i] = 1;
+        next [i] = (position [axis] + (cell [i] + 0.5f) * offset - start)
+            * invDir [axis];
+        delta [i] = offset * invDir [axis];
+      }
+      else if (dir < 0.0f)
+      {
+        step [i] = -1;
+        next [i] = (position [axis] + (cell [i] - 0.5f) * offset - start)
+            * invDir [axis];
+        delta [i] = -offset * invDir [axis];
+      }
+      else
+      {
+        step [i] = 0;
+        next [i] = std::numeric_limits <worldUnit>::max();
+        delta [i] = 0.0f;
+      }
+    }
+
+    bool hit = false;
+
+    while (true)
+    {
+      hit |= checkCell(cell, ray, range, tmpDist);
+
+      int i = next [0] < next [1] ? 0 : 1;
+      i = next [i] < next [2] ? i : 2;
+
+      //Closer hit would be in cell which was already visited
+      if (next [i] >= range)
+      {
+        break;
+      }
+
+      cell [i] += step [i];
+
+      if (cell [i] < -reach || cell [i] > counts [i] - 1 + reach)
+      {
+        break;
+      }
+
+      next [i] += delta [i];
+    }
+
+    return hit;
+  }
+
+  bool LatticeSphere::checkCell (const int *cell,
+                                 const Ray &ray,
+                                 worldUnit &range,
+                                 Vector &tmpDist) const
+  {
+    int first [3];
+    int last [3];
+    bool hit = false;
+
+    for (int i = 0; i < 3; ++i)
+    {
+      first [i] = std::max(cell [i] - reach, 0);
+      last [i] = std::min(cell [i] + reach, counts [i] - 1);
+
+      if (first [i] > last [i])
+      {
+        return false;
+      }
+    }
+
+    Point center(position);
+
+    for (int x = first [0]; x <= last [0]; ++x)
+    {
+      center [X] = position [X] + x * offset;
+
+      for (int y = first [1]; y <= last [1]; ++y)
+      {
+        center [Y] = position [Y] + y * offset;
+
+        for (int z = first [2]; z <= last [2]; ++z)
+        {
+          center [Z] = position [Z] + z * offset;
+
+          hit |= Sphere::checkRay(center, squareRadius, ray, range, tmpDist);
+        }
+      }
+    }
+
+    return hit;
+  }
+
+} /* namespace Model */
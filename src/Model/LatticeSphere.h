@@ -0,0 +1,134 @@
+/// @file Model/LatticeSphere.h
+
+#pragma once
+
+#include "Model/VisibleObject.h"
+
+namespace Model
+{
+
+  /**Regular lattice of equal spheres
+   * Lattice is stored as one object: center of the first sphere
+   * (position), distance between neighbouring centers and amount of
+   * spheres on each axis. Ray walks through lattice cells with 3D-DDA
+   * and only spheres near visited cells are checked, so memory and
+   * intersection cost don't grow with the amount of spheres.
+   *
+   */
+  class LatticeSphere: public VisibleObject
+  {
+    public:
+      /**Creates lattice of spheres
+       * Spheres are placed on positive side of position on each axis.
+       *
+       * @param radius radius of every sphere
+       * @param newOffset distance between neighbouring centers; it has to be > 0
+       * @param countX amount of spheres on X axis
+       * @param countY amount of spheres on Y axis
+       * @param countZ amount of spheres on Z axis
+       */
+      LatticeSphere (worldUnit radius,
+                     worldUnit newOffset,
+                     int countX,
+                     int countY,
+                     int countZ);
+
+      inline virtual ~LatticeSphere ()
+      {
+      }
+
+      /**Calculates normal vector of the sphere closest to given point
+       *
+       * @param point point to calculate normal at
+       * @param normalAtPoint vector to calculate normal in
+       */
+      virtual void getNormal (const Point& point, Vector &normalAtPoint) const;
+
+      /**Calculates bounding box of all spheres
+       *
+       * @param box box to calculate bounds in
+       * @return always true
+       */
+      virtual bool getBoundingBox (BoundingBox &box) const;
+
+      /**Checks if given ray intersects with any sphere of lattice
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param tmpDist temporary vector for calculations
+       * @return true if ray intersects with a sphere in its range, otherwise false
+       */
+      virtual bool checkRay (const Ray &ray,
+                             worldUnit &range,
+                             Vector &tmpDist) const;
+
+      /**Returns distance between neighbouring centers
+       *
+       * @return offset
+       */
+      inline worldUnit getOffset () const
+      {
+        return offset;
+      }
+
+      /**Returns amount of spheres on given axis
+       *
+       * @param axis axis X, Y or Z
+       * @return amount of spheres
+       */
+      inline int getCount (Axis axis) const
+      {
+        return counts [axisIndex(axis)];
+      }
+
+      /**Returns amount of all spheres
+       *
+       * @return amount of spheres
+       */
+      inline quint64 getSphereCount () const
+      {
+        return static_cast <quint64>(counts [0]) * counts [1] * counts [2];
+      }
+
+    private:
+      worldUnit squareRadius;
+      worldUnit offset;
+      worldUnit invOffset;
+
+      /**Amounts of spheres on X, Y and Z axis
+       *
+       */
+      int counts [3];
+
+      /**How many neighbouring cells are checked on each side of visited cell
+       * It's 0 when spheres fit in their cells, overlapping spheres
+       * stick out into neighbouring cells.
+       *
+       */
+      int reach;
+
+      /**Maps axis to index of counts
+       *
+       * @param axis axis X, Y or Z
+       * @return index 0 for X, 1 for Y and 2 for Z
+       */
+      static inline int axisIndex (int axis)
+      {
+        return X - axis;
+      }
+
+      /**Checks spheres of the cell and neighbouring cells
+       *
+       * @param cell index of cell on each axis; it may be outside of lattice
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param tmpDist temporary vector for calculations
+       * @return true if any sphere was hit
+       */
+      bool checkCell (const int *cell,
+                      const Ray &ray,
+                      worldUnit &range,
+                      Vector &tmpDist) const;
+  };
+
+} /* namespace Model */
@@ -2,9 +2,12 @@
 
 #pragma once
 
-#include <QImage>
+#include <QString>
 
 #include "Model/Color.h"
+#include "Model/FastMath.h"
+#include "Model/Texture.h"
+#include "Model/TextureCache.h"
 
 namespace Model
 {
@@ -31,27 +34,43 @@ namespace Model
        * Normal vector is used to calculate point on the texture
        *
        * @param normalAtIntersection
+       * @param footprint size of pixel on unit sphere around the object;
+       *   it selects mip level, 0 selects the base level
+       * @param approximate use approximated math (FastMath) instead of libm
        * @return color from texture
        */
-      inline Color getTextureColor (const SSEVector &normalAtIntersection) const
+      inline Color getTextureColor (const SSEVector &normalAtIntersection,
+                                    float footprint = 0.0f,
+                                    bool approximate = false) const
       {
         if (!texture.isNull())
         {
-          float y = normalAtIntersection [Y];
-          float x = normalAtIntersection [X];
+          float u, v;
 
-          float v = acos(y) / PI;
-          float u = acos(x / sin(PI * v)) / (2 * PI);
+          if (approximate)
+          {
+            FastMath::sphericalUV(normalAtIntersection, u, v);
+          }
+          else
+          {
+            float y = normalAtIntersection [Y];
+            float x = normalAtIntersection [X];
+
+            v = acos(y) / PI;
+            //sin(PI * v) == sin(acos(y)) == sqrt(1 - y * y)
+            u = acos(x / sqrt(1.0f - y * y)) / (2 * PI);
+          }
 
-          int width = texture.width();
-          int height = texture.height();
+          int width = texture.getWidth();
+          int height = texture.getHeight();
 
           float px = width * u;
           float py = height * v;
 
           if ( (px > 0 && px < width) && (py > 0 && py < height))
           {
-            return texture.pixel(px, py);
+            //v covers PI radians of the sphere
+            return texture.sample(u, v, footprint * height * (1.0f / PI));
           }
         }
         return Color(255, 255, 255);
@@ -165,18 +184,28 @@ namespace Model
         return textureFileName;
       }
 
+      /**Returns true if material has loaded texture
+       *
+       * @return is texture loaded
+       */
+      inline bool hasTexture () const
+      {
+        return !texture.isNull();
+      }
+
       /**Sets texture file name
+       * Texels are shared with other materials using the same file.
        *
        */
       void setTexture (const QString &newTextureFileName)
       {
         textureFileName = newTextureFileName;
-        texture.load(textureFileName);
+        texture = TextureCache::getInstance().getTexture(textureFileName);
       }
 
     private:
       QString textureFileName;
-      QImage texture;
+      Texture texture;
       Color diffuse;
       Color specularColor;
       float ior;
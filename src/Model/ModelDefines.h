@@ -77,13 +77,14 @@ namespace Model
      */
     enum ObjectType
     {
-      None, Camera, Light, Sphere, Plane
+      None, Camera, Light, Sphere, Plane, Instance
     };
 
     /**String representation of object types
      *
      */
     const QString CAMERA_NAME = LCSTRING(Camera);
+    const QString INSTANCE_NAME = LCSTRING(Instance);
     const QString LIGHT_NAME = LCSTRING(Light);
     const QString OBJECTS_NAME = LCSTRING(Objects);
     const QString PLANE_NAME = LCSTRING(Plane);
@@ -108,6 +109,35 @@ namespace Model
     const QString MATERIALS_NAME = LCSTRING(Materials);
   }
 
+  namespace Groups
+  {
+    /**String representation of groups section and group in scene file
+     *
+     */
+    const QString GROUPS_NAME = LCSTRING(Groups);
+    const QString GROUP_NAME = LCSTRING(Group);
+  }
+
+  namespace Accelerators
+  {
+    /**Acceleration structures of bounded objects
+     * Auto chooses grid for uniformly distributed objects, BVH otherwise.
+     *
+     */
+    enum AcceleratorType
+    {
+      Auto, Hierarchy, Grid
+    };
+
+    /**String representation of acceleration structures in scene file
+     *
+     */
+    const QString ACCELERATOR_NAME = LCSTRING(Accelerator);
+    const QString AUTO_NAME = LCSTRING(Auto);
+    const QString BVH_NAME = LCSTRING(BVH);
+    const QString GRID_NAME = LCSTRING(Grid);
+  }
+
   namespace Lights
   {
     /**String representation of light section name in scene file
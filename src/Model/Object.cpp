@@ -20,6 +20,7 @@ namespace Model
     if (objectTypes.empty())
     {
       objectTypes [Objects::CAMERA_NAME] = Objects::Camera;
+      objectTypes [Objects::INSTANCE_NAME] = Objects::Instance;
       objectTypes [Objects::LIGHT_NAME] = Objects::Light;
       objectTypes [Objects::PLANE_NAME] = Objects::Plane;
       objectTypes [Objects::SPHERE_NAME] = Objects::Sphere;
@@ -45,6 +46,7 @@ namespace Model
     if (objectTypeNames.empty())
     {
       objectTypeNames [Objects::Camera] = Objects::CAMERA_NAME;
+      objectTypeNames [Objects::Instance] = Objects::INSTANCE_NAME;
       objectTypeNames [Objects::Light] = Objects::LIGHT_NAME;
       objectTypeNames [Objects::Sphere] = Objects::SPHERE_NAME;
     }
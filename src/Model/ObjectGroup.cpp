@@ -0,0 +1,39 @@
+/// @file Model/ObjectGroup.cpp
+
+#include "Model/ObjectGroup.h"
+
+namespace Model
+{
+
+  bool ObjectGroup::addObject (std::unique_ptr <VisibleObject> &&object)
+  {
+    BoundingBox box;
+
+    if (!object->getBoundingBox(box))
+    {
+      return false;
+    }
+
+    objects.emplace_back(std::move(object));
+
+    return true;
+  }
+
+  void ObjectGroup::build ()
+  {
+    BVH::ObjectContainer groupObjects;
+    BoundingBox box;
+
+    bounds.reset();
+
+    for (const auto &object : objects)
+    {
+      object->getBoundingBox(box);
+      bounds.extend(box);
+      groupObjects.push_back(object.get());
+    }
+
+    bvh.build(groupObjects);
+  }
+
+} /* namespace Model */
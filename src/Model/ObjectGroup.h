@@ -0,0 +1,76 @@
+/// @file Model/ObjectGroup.h
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Model/BVH.h"
+#include "Model/BoundingBox.h"
+#include "Model/ModelDefines.h"
+#include "Model/VisibleObject.h"
+
+namespace Model
+{
+
+  /**Group of objects defined once and placed in scene by instances
+   * Objects are kept in group space with their own BVH (bottom level
+   * structure). Instances only reference the group, so memory used by
+   * one instance doesn't depend on size of the group.
+   *
+   */
+  class ObjectGroup
+  {
+    public:
+      typedef std::vector <std::unique_ptr <VisibleObject> > ObjectContainer;
+
+      /**Adds object to group
+       * Only bounded objects can be grouped. Group has to be built
+       * again after adding objects.
+       *
+       * @param object object to add
+       * @return false if object is unbounded
+       */
+      bool addObject (std::unique_ptr <VisibleObject> &&object);
+
+      /**Builds BVH over objects of group
+       *
+       */
+      void build ();
+
+      /**Returns objects of group
+       *
+       * @return objects
+       */
+      inline const ObjectContainer &getObjects () const
+      {
+        return objects;
+      }
+
+      /**Returns bounds of all objects in group space
+       *
+       * @return bounds of group
+       */
+      inline const BoundingBox &getBounds () const
+      {
+        return bounds;
+      }
+
+      /**Returns BVH over objects of group
+       *
+       * @return BVH
+       */
+      inline const BVH &getBVH () const
+      {
+        return bvh;
+      }
+
+    private:
+      ObjectContainer objects;
+      BoundingBox bounds;
+      BVH bvh;
+  };
+
+  typedef std::shared_ptr <const ObjectGroup> ObjectGroupSharedPtr;
+
+} /* namespace Model */
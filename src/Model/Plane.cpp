@@ -1,7 +1,11 @@
 /// @file Plane.cpp
 
+#include <limits>
+
+#include "Model/BoundingBox.h"
 #include "Model/Plane.h"
 #include "Model/Ray.h"
+#include "Model/RayPacket.h"
 
 const float ANGLE_ERROR_VALUE = 0.001f;
 
@@ -43,6 +47,68 @@ bool Plane::checkRay (const Ray& ray, worldUnit& range, Vector&) const
   return false;
 }
 
+bool Plane::getSilhouette (const Ray &ray,
+                           worldUnit range,
+                           worldUnit &edgeDistance,
+                           worldUnit &depth,
+                           worldUnit &exitDistance) const
+{
+  worldUnit height = ray.getStart().dotProduct(normal) - normal.length;
+  worldUnit rayNormalDot = ray.getDir().dotProduct(normal);
+
+  //Ray approaches plane from both sides
+  if (height < 0.0f)
+  {
+    height = -height;
+    rayNormalDot = -rayNormalDot;
+  }
+
+  edgeDistance = height + rayNormalDot * range;
+  depth = range;
+  exitDistance = std::numeric_limits <worldUnit>::max();
+
+  return true;
+}
+
+bool Plane::getBoundingBox (BoundingBox &) const
+{
+  return false;
+}
+
+void Plane::checkRays (const RayPacket &packet, PacketHit &hit) const
+{
+  PacketFloat rayNormalDot = packetAdd(
+      packetAdd(packetMul(packet.dirX, packetSet(normal [X])),
+                packetMul(packet.dirY, packetSet(normal [Y]))),
+      packetMul(packet.dirZ, packetSet(normal [Z])));
+
+  //We are in front/back of plane
+  PacketFloat mask = packetOr(
+      packetLess(packetSet(ANGLE_ERROR_VALUE), rayNormalDot),
+      packetLess(rayNormalDot, packetSet(-ANGLE_ERROR_VALUE)));
+
+  if (packetMask(mask) == 0)
+  {
+    return;
+  }
+
+  //Avoid division by values close to zero in masked out lanes
+  rayNormalDot = packetSelect(packetSet(1.0f), rayNormalDot, mask);
+
+  PacketFloat raystartNormalDot = packetAdd(
+      packetAdd(packetMul(packet.startX, packetSet(normal [X])),
+                packetMul(packet.startY, packetSet(normal [Y]))),
+      packetMul(packet.startZ, packetSet(normal [Z])));
+
+  PacketFloat t = packetDiv(
+      packetSub(packetSet(normal.length), raystartNormalDot), rayNormalDot);
+
+  mask = packetAnd(mask, packetLess(packetSet(0.0f), t));
+  mask = packetAnd(mask, packetLess(t, hit.range));
+
+  hit.update(t, mask, this);
+}
+
 void Plane::setAngles (const Vector &newAngles)
 {
   angles = newAngles;
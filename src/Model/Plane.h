@@ -46,6 +46,16 @@ namespace Model
        */
       void setAngles (const Vector &newAngles);
 
+      /**Returns angles of the plane
+       * Length of the vector is distance of the plane from origin.
+       *
+       * @return angles of the plane
+       */
+      inline const Vector &getAngles () const
+      {
+        return angles;
+      }
+
       /**Set normal vector of the plane
        *
        * @param newNormal normal of the plane
@@ -59,6 +69,13 @@ namespace Model
        */
       virtual void getNormal (const Point& point, Vector &normalAtPoint) const;
 
+      /**Plane is unbounded so it has no bounding box
+       *
+       * @param box unused
+       * @return always false
+       */
+      virtual bool getBoundingBox (BoundingBox &box) const;
+
       /**Checks if given ray intersects with plane
        *
        * @param ray ray to check intersection with
@@ -70,6 +87,33 @@ namespace Model
                              worldUnit &range,
                              Vector &tmpDist) const;
 
+      /**Finds horizon of plane seen by given ray
+       * Plane is cut at the end of the ray, so its silhouette is the
+       * horizon. Distance from it is height of the ray end above plane.
+       *
+       * @param ray primary ray
+       * @param range range of given ray
+       * @param edgeDistance distance of the ray end from plane; negative
+       *   when the ray hits plane
+       * @param depth always range
+       * @param exitDistance nothing is visible behind plane, so it's
+       *   maximum distance
+       * @return always true
+       */
+      virtual bool getSilhouette (const Ray &ray,
+                                  worldUnit range,
+                                  worldUnit &edgeDistance,
+                                  worldUnit &depth,
+                                  worldUnit &exitDistance) const;
+
+      /**Checks intersections of packet of rays with plane
+       * All rays are tested at once with SIMD arithmetic
+       *
+       * @param packet rays to check intersection with
+       * @param hit closest intersections found so far
+       */
+      virtual void checkRays (const RayPacket &packet, PacketHit &hit) const;
+
     private:
       Vector normal;
       Vector angles;
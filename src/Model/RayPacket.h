@@ -0,0 +1,384 @@
+/// @file Model/RayPacket.h
+
+#pragma once
+
+//Include for SIMD operations
+#include <x86intrin.h>
+
+#include "Model/ModelDefines.h"
+#include "Model/Ray.h"
+
+namespace Model
+{
+  //Forward declarations -->
+  class VisibleObject;
+  // <-- Forward declarations
+
+  //Packet wrappers -->
+  /**Packet width follows the widest available instruction set.
+   * All packet arithmetic goes through these wrappers,
+   * so the rest of code doesn't depend on packet width.
+   *
+   */
+#ifdef __AVX__
+
+# define PACKET_SIZE 8
+
+  typedef __m256 PacketFloat;
+
+  inline PacketFloat packetSet (float value)
+  {
+    return _mm256_set1_ps(value);
+  }
+
+  inline PacketFloat packetLoad (const float *values)
+  {
+    return _mm256_load_ps(values);
+  }
+
+  inline void packetStore (float *values, const PacketFloat &packet)
+  {
+    _mm256_store_ps(values, packet);
+  }
+
+  inline PacketFloat packetLoadUnaligned (const float *values)
+  {
+    return _mm256_loadu_ps(values);
+  }
+
+  inline PacketFloat packetAdd (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_add_ps(a, b);
+  }
+
+  inline PacketFloat packetSub (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_sub_ps(a, b);
+  }
+
+  inline PacketFloat packetMul (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_mul_ps(a, b);
+  }
+
+  inline PacketFloat packetDiv (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_div_ps(a, b);
+  }
+
+  inline PacketFloat packetSqrt (const PacketFloat &a)
+  {
+    return _mm256_sqrt_ps(a);
+  }
+
+  inline PacketFloat packetMin (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_min_ps(a, b);
+  }
+
+  inline PacketFloat packetMax (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_max_ps(a, b);
+  }
+
+  inline PacketFloat packetLess (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+  }
+
+  inline PacketFloat packetLessEqual (const PacketFloat &a,
+                                      const PacketFloat &b)
+  {
+    return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+  }
+
+  inline PacketFloat packetAnd (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_and_ps(a, b);
+  }
+
+  inline PacketFloat packetOr (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm256_or_ps(a, b);
+  }
+
+  /**Selects b where mask is set, a otherwise
+   *
+   */
+  inline PacketFloat packetSelect (const PacketFloat &a,
+                                   const PacketFloat &b,
+                                   const PacketFloat &mask)
+  {
+    return _mm256_blendv_ps(a, b, mask);
+  }
+
+  inline int packetMask (const PacketFloat &mask)
+  {
+    return _mm256_movemask_ps(mask);
+  }
+
+#else
+
+# define PACKET_SIZE 4
+
+  typedef __m128 PacketFloat;
+
+  inline PacketFloat packetSet (float value)
+  {
+    return _mm_set1_ps(value);
+  }
+
+  inline PacketFloat packetLoad (const float *values)
+  {
+    return _mm_load_ps(values);
+  }
+
+  inline void packetStore (float *values, const PacketFloat &packet)
+  {
+    _mm_store_ps(values, packet);
+  }
+
+  inline PacketFloat packetLoadUnaligned (const float *values)
+  {
+    return _mm_loadu_ps(values);
+  }
+
+  inline PacketFloat packetAdd (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_add_ps(a, b);
+  }
+
+  inline PacketFloat packetSub (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_sub_ps(a, b);
+  }
+
+  inline PacketFloat packetMul (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_mul_ps(a, b);
+  }
+
+  inline PacketFloat packetDiv (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_div_ps(a, b);
+  }
+
+  inline PacketFloat packetSqrt (const PacketFloat &a)
+  {
+    return _mm_sqrt_ps(a);
+  }
+
+  inline PacketFloat packetMin (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_min_ps(a, b);
+  }
+
+  inline PacketFloat packetMax (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_max_ps(a, b);
+  }
+
+  inline PacketFloat packetLess (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_cmplt_ps(a, b);
+  }
+
+  inline PacketFloat packetLessEqual (const PacketFloat &a,
+                                      const PacketFloat &b)
+  {
+    return _mm_cmple_ps(a, b);
+  }
+
+  inline PacketFloat packetAnd (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_and_ps(a, b);
+  }
+
+  inline PacketFloat packetOr (const PacketFloat &a, const PacketFloat &b)
+  {
+    return _mm_or_ps(a, b);
+  }
+
+  /**Selects b where mask is set, a otherwise
+   *
+   */
+  inline PacketFloat packetSelect (const PacketFloat &a,
+                                   const PacketFloat &b,
+                                   const PacketFloat &mask)
+  {
+#if __SSE4_1__ == 1
+    return _mm_blendv_ps(a, b, mask);
+#else
+    return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+#endif
+  }
+
+  inline int packetMask (const PacketFloat &mask)
+  {
+    return _mm_movemask_ps(mask);
+  }
+
+#endif
+  // <-- Packet wrappers
+
+  /**Packet of coherent rays
+   * Rays are kept both as single rays, used after packet diverges,
+   * and as structure of arrays used by SIMD intersection tests.
+   *
+   */
+  struct RayPacket
+  {
+      PacketFloat startX, startY, startZ;
+      PacketFloat dirX, dirY, dirZ;
+      PacketFloat invDirX, invDirY, invDirZ;
+
+      Ray rays [PACKET_SIZE];
+
+      /**Amount of used rays; the rest of lanes is inactive
+       *
+       */
+      int rayCount;
+
+      /**Copies single rays to SIMD lanes
+       * Unused lanes are filled with copies of the first ray.
+       *
+       * @param newRayCount amount of used rays
+       */
+      inline void update (int newRayCount)
+      {
+        alignas(32) float values [9] [PACKET_SIZE];
+        const worldUnit minComponent = 1e-20f;
+
+        rayCount = newRayCount;
+
+        for (int lane = 0; lane < PACKET_SIZE; ++lane)
+        {
+          const Ray &ray = rays [lane < rayCount ? lane : 0];
+
+          values [0] [lane] = ray.getStart() [X];
+          values [1] [lane] = ray.getStart() [Y];
+          values [2] [lane] = ray.getStart() [Z];
+
+          const int axes [3] = { X, Y, Z };
+
+          for (int i = 0; i < 3; ++i)
+          {
+            worldUnit component = ray.getDir() [axes [i]];
+
+            values [3 + i] [lane] = component;
+
+            if (component > -minComponent && component < minComponent)
+            {
+              component = component < 0 ? -minComponent : minComponent;
+            }
+
+            values [6 + i] [lane] = 1.0f / component;
+          }
+        }
+
+        startX = packetLoad(values [0]);
+        startY = packetLoad(values [1]);
+        startZ = packetLoad(values [2]);
+        dirX = packetLoad(values [3]);
+        dirY = packetLoad(values [4]);
+        dirZ = packetLoad(values [5]);
+        invDirX = packetLoad(values [6]);
+        invDirY = packetLoad(values [7]);
+        invDirZ = packetLoad(values [8]);
+      }
+  };
+
+  /**Closest intersections found for packet of rays
+   *
+   */
+  struct PacketHit
+  {
+      /**Distance to the closest intersection of each ray
+       * Inactive lanes have zero range so nothing can be hit there.
+       *
+       */
+      PacketFloat range;
+
+      const VisibleObject *objects [PACKET_SIZE];
+
+      /**Sets range of active rays and clears hits
+       *
+       * @param maxRange maximum range of rays
+       * @param rayCount amount of active rays
+       */
+      inline void reset (worldUnit maxRange, int rayCount)
+      {
+        alignas(32) float ranges [PACKET_SIZE];
+
+        for (int lane = 0; lane < PACKET_SIZE; ++lane)
+        {
+          ranges [lane] = lane < rayCount ? maxRange : 0.0f;
+          objects [lane] = nullptr;
+        }
+
+        range = packetLoad(ranges);
+      }
+
+      /**Updates range and object of rays selected by mask
+       *
+       * @param newRange new ranges, used only where mask is set
+       * @param mask lanes to update
+       * @param object object hit by selected rays
+       */
+      inline void update (const PacketFloat &newRange,
+                          const PacketFloat &mask,
+                          const VisibleObject *object)
+      {
+        int bits = packetMask(mask);
+
+        if (bits == 0)
+        {
+          return;
+        }
+
+        range = packetSelect(range, newRange, mask);
+
+        for (int lane = 0; lane < PACKET_SIZE; ++lane)
+        {
+          if (bits & (1 << lane))
+          {
+            objects [lane] = object;
+          }
+        }
+      }
+
+      /**Updates range and object of single ray
+       *
+       * @param lane index of ray in packet
+       * @param newRange new range of ray
+       * @param object object hit by ray
+       */
+      inline void update (int lane,
+                          worldUnit newRange,
+                          const VisibleObject *object)
+      {
+        alignas(32) float ranges [PACKET_SIZE];
+
+        packetStore(ranges, range);
+        ranges [lane] = newRange;
+        range = packetLoad(ranges);
+
+        objects [lane] = object;
+      }
+
+      /**Returns range of ray in given lane
+       *
+       * @param lane index of ray in packet
+       * @return range of ray
+       */
+      inline worldUnit getRange (int lane) const
+      {
+        alignas(32) float ranges [PACKET_SIZE];
+
+        packetStore(ranges, range);
+
+        return ranges [lane];
+      }
+  };
+
+} /* namespace Model */
@@ -0,0 +1,131 @@
+/// @file Model/RenderStats.h
+
+#pragma once
+
+#include <QtGlobal>
+
+/**Adds value to counter of render stats
+ * Counters are compiled out when RENDER_STATS isn't defined (Release build),
+ * so they cost nothing in hot paths.
+ *
+ */
+#ifdef RENDER_STATS
+# define RENDER_STATS_ADD(counter, value) ((counter) += (value))
+#else
+# define RENDER_STATS_ADD(counter, value) ((void) (counter))
+#endif
+
+namespace Model
+{
+
+  /**Counters of traced rays and work done in hot paths
+   * Each renderer counts its own rays, so no synchronization is needed.
+   * Counters of all renderers are summed after the frame.
+   *
+   */
+  struct RenderStats
+  {
+      quint64 primaryRays;
+      quint64 reflectionRays;
+      quint64 refractionRays;
+      quint64 shadowRays;
+
+      /**Ray-object intersection tests, one per ray and object
+       *
+       */
+      quint64 intersectionTests;
+
+      /**Rays which weren't reflected any further because their
+       * contribution dropped below COLOR_MIN_VALUE
+       *
+       */
+      quint64 earlyTerminations;
+
+      quint64 totalInternalReflections;
+      quint64 textureLookups;
+
+      /**Time of the last build of acceleration structure [ns] and memory
+       * allocated by it [B]. They describe the scene, not the rays, so
+       * they are copied from scene after counters are summed.
+       *
+       */
+      quint64 accelerationBuildTime;
+      quint64 accelerationMemory;
+
+      inline RenderStats ()
+      {
+        reset();
+      }
+
+      /**Returns true if counters are compiled in
+       *
+       * @return are counters enabled
+       */
+      static inline bool isEnabled ()
+      {
+#ifdef RENDER_STATS
+        return true;
+#else
+        return false;
+#endif
+      }
+
+      /**Sets all counters to 0
+       *
+       */
+      inline void reset ()
+      {
+        primaryRays = 0;
+        reflectionRays = 0;
+        refractionRays = 0;
+        shadowRays = 0;
+        intersectionTests = 0;
+        earlyTerminations = 0;
+        totalInternalReflections = 0;
+        textureLookups = 0;
+        accelerationBuildTime = 0;
+        accelerationMemory = 0;
+      }
+
+      /**Adds counters of other stats
+       * Acceleration structure data isn't added.
+       *
+       * @param other stats to add
+       * @return this
+       */
+      inline RenderStats &operator += (const RenderStats &other)
+      {
+        primaryRays += other.primaryRays;
+        reflectionRays += other.reflectionRays;
+        refractionRays += other.refractionRays;
+        shadowRays += other.shadowRays;
+        intersectionTests += other.intersectionTests;
+        earlyTerminations += other.earlyTerminations;
+        totalInternalReflections += other.totalInternalReflections;
+        textureLookups += other.textureLookups;
+
+        return *this;
+      }
+
+      /**Returns amount of all traced rays
+       *
+       * @return amount of rays
+       */
+      inline quint64 getTotalRays () const
+      {
+        return primaryRays + reflectionRays + refractionRays + shadowRays;
+      }
+
+      /**Returns average amount of intersection tests done for one ray
+       *
+       * @return intersection tests per ray; 0 if no ray was traced
+       */
+      inline double getIntersectionTestsPerRay () const
+      {
+        quint64 rays = getTotalRays();
+
+        return rays > 0 ? intersectionTests / static_cast <double>(rays) : 0.0;
+      }
+  };
+
+} /* namespace Model */
@@ -1,14 +1,20 @@
 /// @file Model/Renderer.cpp
 
-#include "Controller/RendererThread.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "Controller/RenderParams.h"
 #include "Model/Camera.h"
 #include "Model/Color.h"
 #include "Model/Light.h"
 #include "Model/Material.h"
 #include "Model/Point.h"
 #include "Model/Ray.h"
+#include "Model/RayPacket.h"
 #include "Model/Renderer.h"
 #include "Model/RenderTileData.h"
+#include "Model/ReprojectionCache.h"
 #include "Model/Scene.h"
 #include "Model/Vector.h"
 #include "Model/VisibleObject.h"
@@ -39,9 +45,32 @@ void Renderer::render (const RenderTileData &tile)
   Vector direction;
   Point startOnScreen(camera.getScreenTopLeft());
   Point currentOnScreen;
-  Ray ray;
+  RayPacket packet;
+  PacketHit hit;
   Color rayResult;
   const VisibleObject *objectWeAreIn = &renderParams->scene->getWorldObject();
+  ReprojectionCache *cache = renderParams->reprojectionCache.get();
+
+  //Cached occluders may belong to previous scene
+  lastOccluders.assign(renderParams->scene->getLights().size(), nullptr);
+
+  if (renderParams->pixelStep > 1)
+  {
+    renderBlocks(tile);
+    return;
+  }
+
+  if (renderParams->adaptiveAASamples > 1)
+  {
+    renderAdaptiveAA(tile);
+    return;
+  }
+
+  if (renderParams->analyticAA)
+  {
+    renderAnalyticAA(tile);
+    return;
+  }
 
   const imageUnit diffToNewLine = BPP * (tile.imageWidth - tile.width);
   imageUnit R = BPP * (tile.topLeft.x + tile.topLeft.y * tile.imageWidth);
@@ -51,36 +80,87 @@ void Renderer::render (const RenderTileData &tile)
   startOnScreen += camera.screenWidthDelta * tile.topLeft.x;
   startOnScreen += camera.screenHeightDelta * tile.topLeft.y;
 
-  for (imageUnit iLine = tile.topLeft.y; iLine < tile.bottomRight.y; ++iLine)
+  //Checking if thread is allowed to run once per line is enough
+  //to stop quickly
+  for (imageUnit iLine = tile.topLeft.y;
+      iLine < tile.bottomRight.y
+          && renderParams->allowRunning.load(std::memory_order_relaxed);
+      ++iLine)
   {
     currentOnScreen = startOnScreen;
 
-    for (imageUnit iCol = tile.topLeft.x;
-        renderParams->allowRunning && iCol < tile.bottomRight.x; ++iCol)
-    //Checking if thread is allowed to run: renderParams->allowRunning
+    for (imageUnit iCol = tile.topLeft.x; iCol < tile.bottomRight.x; iCol +=
+        PACKET_SIZE)
     {
-      if (camera.getType() == Camera::Conic)
+      //Neighbouring pixels are traced together as one packet of primary rays
+      int rayCount = std::min(PACKET_SIZE, tile.bottomRight.x - iCol);
+
+      for (int lane = 0; lane < rayCount; ++lane)
       {
-        camera.getDirection(currentOnScreen, direction);
+        if (camera.getType() == Camera::Conic)
+        {
+          camera.getDirection(currentOnScreen, direction);
+        }
+
+        packet.rays [lane].setParams(currentOnScreen, direction);
+
+        currentOnScreen += camera.screenWidthDelta;
       }
 
-      ray.setParams(currentOnScreen, direction);
+      packet.update(rayCount);
+      RENDER_STATS_ADD(stats.primaryRays, rayCount);
+      hit.reset(viewDistance, rayCount);
+      renderParams->scene->findIntersections(packet, hit, stats);
 
-      int refractionDepth = renderParams->refractionDeep;
+      //Packet diverges after first hit, so rays are continued one by one
+      for (int lane = 0; lane < rayCount; ++lane)
+      {
+        int refractionDepth = renderParams->refractionDeep;
+        size_t pixelIdx = iLine * tile.imageWidth + iCol + lane;
 
-      rayResult.setDefaultColor();
-      shootRay(ray, rayResult, viewDistance, refractionDepth, objectWeAreIn);
+        //Surface was shaded in one of previous frames
+        if (cache != nullptr
+            && cache->isValid(pixelIdx, hit.objects [lane],
+                              hit.getRange(lane)))
+        {
+          const colorType *color = cache->getColor(pixelIdx);
 
-      tile.imageData [R] = rayResult.red();
-      R += BPP;
+          tile.imageData [R] = color [0];
+          tile.imageData [G] = color [1];
+          tile.imageData [B] = color [2];
+        }
+        else
+        {
+          Point hitPoint;
+          bool viewDependent = false;
 
-      tile.imageData [G] = rayResult.green();
-      G += BPP;
+          //Ray is changed by shootRay, so hit point is calculated first
+          if (cache != nullptr)
+          {
+            hitPoint = packet.rays [lane].getStart().move(
+                packet.rays [lane].getDir().multiply(hit.getRange(lane)));
+          }
+
+          rayResult.setDefaultColor();
+          shootRay(packet.rays [lane], rayResult, viewDistance,
+                   refractionDepth, objectWeAreIn, hit.objects [lane],
+                   hit.getRange(lane), &viewDependent);
 
-      tile.imageData [B] = rayResult.blue();
-      B += BPP;
+          if (cache != nullptr)
+          {
+            cache->store(pixelIdx, hit.objects [lane], hitPoint, rayResult,
+                         !viewDependent);
+          }
 
-      currentOnScreen += camera.screenWidthDelta;
+          tile.imageData [R] = rayResult.red();
+          tile.imageData [G] = rayResult.green();
+          tile.imageData [B] = rayResult.blue();
+        }
+
+        R += BPP;
+        G += BPP;
+        B += BPP;
+      }
     }
 
     startOnScreen += camera.screenHeightDelta;
@@ -91,30 +171,470 @@ void Renderer::render (const RenderTileData &tile)
   }
 }
 
+void Renderer::renderBlocks (const RenderTileData &tile)
+{
+  const imageUnit step = renderParams->pixelStep;
+  //Samples of previous pass which are corners of blocks in this one
+  const imageUnit reusedStep =
+      renderParams->previousPixelStep == 2 * step ? 2 * step : 0;
+  const VisibleObject *objectWeAreIn = &renderParams->scene->getWorldObject();
+  worldUnit viewDistance = renderParams->scene->getCamera().getViewDistance();
+  RayPacket packet;
+  PacketHit hit;
+  Color rayResult;
+  imageUnit laneX [PACKET_SIZE];
+
+  //Blocks are aligned to image, so blocks of consecutive passes overlap
+  imageUnit firstX = tile.topLeft.x - tile.topLeft.x % step;
+  imageUnit firstY = tile.topLeft.y - tile.topLeft.y % step;
+
+  for (imageUnit y = firstY;
+      y < tile.bottomRight.y
+          && renderParams->allowRunning.load(std::memory_order_relaxed);
+      y += step)
+  {
+    bool reuseLine = reusedStep > 0 && y % reusedStep == 0;
+    imageUnit blockTop = std::max(y, tile.topLeft.y);
+    imageUnit blockBottom = std::min(y + step, tile.bottomRight.y);
+    imageUnit x = firstX;
+
+    while (x < tile.bottomRight.x)
+    {
+      int rayCount = 0;
+
+      //Blocks filled by previous pass are skipped
+      for (; rayCount < PACKET_SIZE && x < tile.bottomRight.x; x += step)
+      {
+        if (!reuseLine || x % reusedStep != 0)
+        {
+          laneX [rayCount] = x;
+          getPrimaryRay(x, y, packet.rays [rayCount]);
+          ++rayCount;
+        }
+      }
+
+      if (rayCount == 0)
+      {
+        continue;
+      }
+
+      packet.update(rayCount);
+      RENDER_STATS_ADD(stats.primaryRays, rayCount);
+      hit.reset(viewDistance, rayCount);
+      renderParams->scene->findIntersections(packet, hit, stats);
+
+      for (int lane = 0; lane < rayCount; ++lane)
+      {
+        rayResult.setDefaultColor();
+        shootRay(packet.rays [lane], rayResult, viewDistance,
+                 renderParams->refractionDeep, objectWeAreIn,
+                 hit.objects [lane], hit.getRange(lane));
+
+        colorType red = rayResult.red();
+        colorType green = rayResult.green();
+        colorType blue = rayResult.blue();
+        imageUnit blockLeft = std::max(laneX [lane], tile.topLeft.x);
+        imageUnit blockRight = std::min(laneX [lane] + step,
+                                        tile.bottomRight.x);
+
+        for (imageUnit blockY = blockTop; blockY < blockBottom; ++blockY)
+        {
+          imageUnit R = BPP * (blockLeft + blockY * tile.imageWidth);
+
+          for (imageUnit blockX = blockLeft; blockX < blockRight; ++blockX)
+          {
+            tile.imageData [R++ ] = red;
+            tile.imageData [R++ ] = green;
+            tile.imageData [R++ ] = blue;
+          }
+        }
+      }
+    }
+  }
+}
+
+void Renderer::traceTileHits (const RenderTileData &tile)
+{
+  worldUnit viewDistance = renderParams->scene->getCamera().getViewDistance();
+  RayPacket packet;
+  PacketHit hit;
+
+  //Tile is traced with one pixel border, so neighbours of edge pixels
+  //are known and edges of neighbouring tiles match
+  const imageUnit left = tile.topLeft.x - 1;
+  const imageUnit top = tile.topLeft.y - 1;
+  const imageUnit width = tile.width + 2;
+  const imageUnit height = tile.height + 2;
+  const size_t pixelCount = width * height;
+
+  tileObjects.assign(pixelCount, nullptr);
+  tileRanges.assign(pixelCount, viewDistance);
+  tileColors.resize(pixelCount);
+  tileShaded.assign(pixelCount, false);
+
+  for (imageUnit y = 0;
+      y < height && renderParams->allowRunning.load(std::memory_order_relaxed);
+      ++y)
+  {
+    for (imageUnit x = 0; x < width; x += PACKET_SIZE)
+    {
+      int rayCount = std::min(PACKET_SIZE, width - x);
+
+      for (int lane = 0; lane < rayCount; ++lane)
+      {
+        getPrimaryRay(left + x + lane, top + y, packet.rays [lane]);
+      }
+
+      packet.update(rayCount);
+      RENDER_STATS_ADD(stats.primaryRays, rayCount);
+      hit.reset(viewDistance, rayCount);
+      renderParams->scene->findIntersections(packet, hit, stats);
+
+      for (int lane = 0; lane < rayCount; ++lane)
+      {
+        tileObjects [y * width + x + lane] = hit.objects [lane];
+        tileRanges [y * width + x + lane] = hit.getRange(lane);
+      }
+    }
+  }
+}
+
+void Renderer::renderAnalyticAA (const RenderTileData &tile)
+{
+  const Camera &camera = renderParams->scene->getCamera();
+  worldUnit viewDistance = camera.getViewDistance();
+  const VisibleObject *objectWeAreIn = &renderParams->scene->getWorldObject();
+  Ray ray;
+
+  const imageUnit left = tile.topLeft.x - 1;
+  const imageUnit top = tile.topLeft.y - 1;
+  const imageUnit width = tile.width + 2;
+  const imageUnit height = tile.height + 2;
+
+  traceTileHits(tile);
+
+  const int neighbours [4] =
+    { -width, -1, 1, width };
+
+  for (imageUnit y = 1;
+      y < height - 1
+          && renderParams->allowRunning.load(std::memory_order_relaxed);
+      ++y)
+  {
+    imageUnit R = BPP * (tile.topLeft.x + (top + y) * tile.imageWidth);
+
+    for (imageUnit x = 1; x < width - 1; ++x, R += BPP)
+    {
+      size_t pixelIdx = y * width + x;
+      const VisibleObject *object = tileObjects [pixelIdx];
+      Color pixel = getTileColor(left + x, top + y, pixelIdx);
+      worldUnit edgeDistance, depth, exitDistance;
+
+      getPrimaryRay(left + x, top + y, ray);
+
+      //Part of pixel isn't covered by its own object, the rest is behind it
+      if (object != nullptr
+          && object->getSilhouette(ray, viewDistance, edgeDistance, depth,
+                                   exitDistance))
+      {
+        float coverage = getCoverage(edgeDistance, depth);
+
+        if (coverage < 1.0f)
+        {
+          Color behind;
+
+          behind.setDefaultColor();
+
+          if (exitDistance + FLOAT_EPSILON < viewDistance)
+          {
+            Ray continuation;
+
+            continuation.setParams(
+                ray.getStart().move(
+                    ray.getDir().multiply(exitDistance + FLOAT_EPSILON)),
+                ray.getDir());
+
+            RENDER_STATS_ADD(stats.primaryRays, 1);
+            shootRay(continuation, behind, viewDistance - exitDistance,
+                     renderParams->refractionDeep, objectWeAreIn);
+          }
+
+          pixel *= coverage;
+          pixel += behind * (1.0f - coverage);
+        }
+      }
+
+      //Pixel can be partly covered by object of neighbour which is in front
+      float neighbourCoverage = 0.0f;
+      size_t neighbourIdx = pixelIdx;
+
+      for (int offset : neighbours)
+      {
+        const VisibleObject *other = tileObjects [pixelIdx + offset];
+
+        if (other == nullptr || other == object
+            || !other->getSilhouette(ray, viewDistance, edgeDistance, depth,
+                                     exitDistance) || edgeDistance <= 0.0f
+            || (object != nullptr && depth >= tileRanges [pixelIdx]))
+        {
+          continue;
+        }
+
+        float coverage = getCoverage(edgeDistance, depth);
+
+        if (coverage > neighbourCoverage)
+        {
+          neighbourCoverage = coverage;
+          neighbourIdx = pixelIdx + offset;
+        }
+      }
+
+      if (neighbourCoverage > 0.0f)
+      {
+        imageUnit neighbourX = left + neighbourIdx % width;
+        imageUnit neighbourY = top + neighbourIdx / width;
+
+        pixel *= 1.0f - neighbourCoverage;
+        pixel += getTileColor(neighbourX, neighbourY, neighbourIdx)
+            * neighbourCoverage;
+      }
+
+      tile.imageData [R] = pixel.red();
+      tile.imageData [R + 1] = pixel.green();
+      tile.imageData [R + 2] = pixel.blue();
+    }
+  }
+}
+
+void Renderer::renderAdaptiveAA (const RenderTileData &tile)
+{
+  //Samples are placed in cells of square grid
+  const int gridSize = static_cast <int>(std::sqrt(
+      static_cast <float>(renderParams->adaptiveAASamples)));
+  const imageUnit left = tile.topLeft.x - 1;
+  const imageUnit top = tile.topLeft.y - 1;
+  const imageUnit width = tile.width + 2;
+  const imageUnit height = tile.height + 2;
+
+  traceTileHits(tile);
+
+  for (imageUnit y = 1;
+      y < height - 1
+          && renderParams->allowRunning.load(std::memory_order_relaxed);
+      ++y)
+  {
+    imageUnit R = BPP * (tile.topLeft.x + (top + y) * tile.imageWidth);
+
+    for (imageUnit x = 1; x < width - 1; ++x, R += BPP)
+    {
+      size_t pixelIdx = y * width + x;
+      Color pixel;
+
+      if (isEdgePixel(left + x, top + y, pixelIdx, width))
+      {
+        pixel = getSupersampledColor(left + x, top + y, gridSize);
+      }
+      else
+      {
+        pixel = getTileColor(left + x, top + y, pixelIdx);
+      }
+
+      tile.imageData [R] = pixel.red();
+      tile.imageData [R + 1] = pixel.green();
+      tile.imageData [R + 2] = pixel.blue();
+    }
+  }
+}
+
+bool Renderer::isEdgePixel (imageUnit x,
+                            imageUnit y,
+                            size_t pixelIdx,
+                            imageUnit width)
+{
+  const int threshold = renderParams->adaptiveAAThreshold;
+  const int neighbours [4] =
+    { -width, -1, 1, width };
+
+  //Silhouettes are found without shading, their pixels are supersampled
+  //anyway
+  for (int offset : neighbours)
+  {
+    if (tileObjects [pixelIdx + offset] != tileObjects [pixelIdx])
+    {
+      return true;
+    }
+  }
+
+  const Color &pixel = getTileColor(x, y, pixelIdx);
+
+  for (int offset : neighbours)
+  {
+    const Color &neighbour = getTileColor(x + offset % width,
+                                          y + offset / width,
+                                          pixelIdx + offset);
+
+    if (std::abs(pixel.red() - neighbour.red()) > threshold
+        || std::abs(pixel.green() - neighbour.green()) > threshold
+        || std::abs(pixel.blue() - neighbour.blue()) > threshold)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+Color Renderer::getSupersampledColor (imageUnit x, imageUnit y, int gridSize)
+{
+  const Camera &camera = renderParams->scene->getCamera();
+  worldUnit viewDistance = camera.getViewDistance();
+  const VisibleObject *objectWeAreIn = &renderParams->scene->getWorldObject();
+  const int sampleCount = gridSize * gridSize;
+  const float cellSize = 1.0f / gridSize;
+  RayPacket packet;
+  PacketHit hit;
+  Color sample;
+  Color sum(0, 0, 0);
+
+  for (int first = 0; first < sampleCount; first += PACKET_SIZE)
+  {
+    int rayCount = std::min(PACKET_SIZE, sampleCount - first);
+
+    //Each sample is jittered in its own cell of pixel
+    for (int lane = 0; lane < rayCount; ++lane)
+    {
+      int sampleIdx = first + lane;
+      worldUnit sampleX = x - 0.5f
+          + (sampleIdx % gridSize + getJitter(x, y, 2 * sampleIdx)) * cellSize;
+      worldUnit sampleY = y - 0.5f
+          + (sampleIdx / gridSize + getJitter(x, y, 2 * sampleIdx + 1))
+              * cellSize;
+
+      getPrimaryRay(sampleX, sampleY, packet.rays [lane]);
+    }
+
+    packet.update(rayCount);
+    RENDER_STATS_ADD(stats.primaryRays, rayCount);
+    hit.reset(viewDistance, rayCount);
+    renderParams->scene->findIntersections(packet, hit, stats);
+
+    for (int lane = 0; lane < rayCount; ++lane)
+    {
+      sample.setDefaultColor();
+      shootRay(packet.rays [lane], sample, viewDistance,
+               renderParams->refractionDeep, objectWeAreIn,
+               hit.objects [lane], hit.getRange(lane));
+
+      //Saturated samples are averaged, so highlights don't spread
+      sum += Color(sample.red(), sample.green(), sample.blue());
+    }
+  }
+
+  sum *= 1.0f / sampleCount;
+
+  return sum;
+}
+
+inline float Renderer::getJitter (imageUnit x, imageUnit y, int idx) const
+{
+  //Hash of pixel and sample makes image independent of tiles and threads
+  quint32 hash = static_cast <quint32>(x) * 73856093u
+      ^ static_cast <quint32>(y) * 19349663u
+      ^ static_cast <quint32>(idx) * 83492791u;
+
+  hash ^= hash >> 16;
+  hash *= 0x7feb352du;
+  hash ^= hash >> 15;
+  hash *= 0x846ca68bu;
+  hash ^= hash >> 16;
+
+  return (hash >> 8) * (1.0f / (1u << 24));
+}
+
+inline void Renderer::getPrimaryRay (worldUnit x, worldUnit y, Ray &ray) const
+{
+  const Camera &camera = renderParams->scene->getCamera();
+  Point onScreen(camera.getScreenTopLeft());
+  Vector direction(camera.getDirection());
+
+  onScreen += camera.screenWidthDelta * x;
+  onScreen += camera.screenHeightDelta * y;
+
+  if (camera.getType() == Camera::Conic)
+  {
+    camera.getDirection(onScreen, direction);
+  }
+
+  ray.setParams(onScreen, direction);
+}
+
+const Color &Renderer::getTileColor (imageUnit x,
+                                     imageUnit y,
+                                     size_t pixelIdx)
+{
+  if (!tileShaded [pixelIdx])
+  {
+    Ray ray;
+
+    getPrimaryRay(x, y, ray);
+    tileColors [pixelIdx].setDefaultColor();
+    shootRay(ray, tileColors [pixelIdx],
+             renderParams->scene->getCamera().getViewDistance(),
+             renderParams->refractionDeep,
+             &renderParams->scene->getWorldObject(), tileObjects [pixelIdx],
+             tileRanges [pixelIdx]);
+    tileShaded [pixelIdx] = true;
+  }
+
+  return tileColors [pixelIdx];
+}
+
+inline float Renderer::getCoverage (worldUnit edgeDistance,
+                                    worldUnit depth) const
+{
+  //Silhouette is treated as straight line crossing the pixel
+  float coverage = 0.5f
+      - edgeDistance
+          / renderParams->scene->getCamera().getPixelFootprint(depth);
+
+  return std::min(std::max(coverage, 0.0f), 1.0f);
+}
+
 inline void Renderer::shootRay (Ray & ray,
                                 Color &resultColor,
                                 worldUnit mainViewDistance,
                                 int refractionDepth,
-                                const VisibleObject *objectWeAreIn) const
+                                const VisibleObject *objectWeAreIn,
+                                const VisibleObject *firstObject,
+                                worldUnit firstDistance,
+                                bool *viewDependent) const
 {
-  const VisibleObject *currentObject = nullptr;
+  const VisibleObject *currentObject = firstObject;
   float reflectionCoef = 1;
   float lightContrCoef = 0;
-  worldUnit rayStartIntersectDist = mainViewDistance;
+  worldUnit rayStartIntersectDist = firstDistance;
   int reflecionDeep = renderParams->reflectionDeep;
+  //Distance travelled by ray; it's used to select texture mip level
+  worldUnit pathDistance = 0.0f;
   bool inShadow;
+  bool reflected = false;
 
   while (reflecionDeep-- >= 0)
   {
-    rayStartIntersectDist = mainViewDistance;
-    //Find intersection
-    currentObject = nullptr;
-    for (const auto &object : renderParams->scene->getObjects())
+    //First intersection may be already found by packet tracing
+    if (rayStartIntersectDist < 0.0f)
     {
-      if (object->checkRay(ray, rayStartIntersectDist, *tmpDistance))
+      rayStartIntersectDist = mainViewDistance;
+
+      //Refracted rays are counted by shootRefractedRay
+      if (reflected)
       {
-        currentObject = object.get();
+        RENDER_STATS_ADD(stats.reflectionRays, 1);
       }
+
+      //Find intersection
+      currentObject = renderParams->scene->findIntersection(
+          ray, rayStartIntersectDist, *tmpDistance, stats);
     }
 
     //If there is any intersection?
@@ -124,18 +644,22 @@ inline void Renderer::shootRay (Ray & ray,
       Point intersection;
 
       *rayStartIntersect = ray.getDir().multiply(rayStartIntersectDist);
+      pathDistance += rayStartIntersectDist;
 
       //Calculate intersection point
       intersection = ray.getStart().move(*rayStartIntersect);
 
-      //Get normal vector at intersection point
-      currentObject->getNormal(intersection, normalAtIntersection);
+      //Get hit surface (object of instanced group) and its normal vector
+      worldUnit hitSurfaceSize;
+      const VisibleObject &hitSurface = currentObject->getHitSurface(
+          ray, rayStartIntersectDist, intersection, normalAtIntersection,
+          hitSurfaceSize);
 
       //move intersection point by epsilon, needed for error correction
       Vector correction(normalAtIntersection * FLOAT_EPSILON);
       intersection += correction;
 
-      const Material &currentMaterial = currentObject->getMaterial();
+      const Material &currentMaterial = hitSurface.getMaterial();
 
       //(1.0f / COLOR_COUNT) because few lines bellow we do color * color
       lightContrCoef = reflectionCoef * (1.0f / COLOR_COUNT);
@@ -145,7 +669,13 @@ inline void Renderer::shootRay (Ray & ray,
         lightContrCoef *= (1.0f - currentMaterial.getReflection());
       }
 
-      float transparency = currentObject->getMaterial().getTransparency();
+      float transparency = currentMaterial.getTransparency();
+
+      if (viewDependent != nullptr && !reflected)
+      {
+        *viewDependent = currentMaterial.getReflection() > 0.0f
+            || transparency > 0.01f;
+      }
 
       //calculate refracted ray and transparent sphere color
       Color transpColor = shootRefractedRay(ray, transparency, refractionDepth,
@@ -153,12 +683,28 @@ inline void Renderer::shootRay (Ray & ray,
                                             rayStartIntersectDist,
                                             lightContrCoef, correction,
                                             normalAtIntersection, intersection,
-                                            *currentObject, objectWeAreIn);
+                                            hitSurface, objectWeAreIn);
 
       resultColor += transpColor;
 
+      //Texture is mapped on unit sphere, so pixel is scaled by object size
+      float textureFootprint = 0.0f;
+
+      if (currentMaterial.hasTexture())
+      {
+        RENDER_STATS_ADD(stats.textureLookups, 1);
+
+        if (hitSurfaceSize > 0.0f)
+        {
+          textureFootprint =
+              renderParams->scene->getCamera().getPixelFootprint(pathDistance)
+                  / hitSurfaceSize;
+        }
+      }
+
       Color textureColor = currentMaterial.getTextureColor(
-          normalAtIntersection);
+          normalAtIntersection, textureFootprint,
+          renderParams->approximateMath);
 
       //Calculate reflection vector
       Vector reflectedRay(ray.getDir());
@@ -168,8 +714,11 @@ inline void Renderer::shootRay (Ray & ray,
       //reflectedRay is still normalized;
 
       //Calculate light contribution
-      for (const Light &light : renderParams->scene->getLights())
+      const Scene::LighContainer &lights = renderParams->scene->getLights();
+      for (size_t lightIdx = 0; lightIdx < lights.size(); ++lightIdx)
       {
+        const Light &light = lights [lightIdx];
+
         light.getPosition().diff(intersection, *pointLightDist);
         //if angle between light and normal vector at intersection is higher than 90 degrees
         if (normalAtIntersection.dotProduct(*pointLightDist) <= 0.0f)
@@ -191,15 +740,10 @@ inline void Renderer::shootRay (Ray & ray,
         //TODO: Can we check this once before starting rendering?
         if (renderParams->shadows)
         {
-          for (const auto &object : renderParams->scene->getObjects())
-          {
-            if (object->checkRay(*lightRay, pointLightDist->length,
-                                 *tmpDistance))
-            {
-              inShadow = true;
-              break;
-            }
-          }
+          RENDER_STATS_ADD(stats.shadowRays, 1);
+          inShadow = renderParams->scene->isOccluded(
+              *lightRay, pointLightDist->length, *tmpDistance,
+              lastOccluders [lightIdx], stats);
         }
 
         if (!inShadow)
@@ -249,8 +793,15 @@ inline void Renderer::shootRay (Ray & ray,
       reflectionCoef *= currentMaterial.getReflection();
 
       if ( (reflectionCoef < COLOR_MIN_VALUE)
-          || (objectWeAreIn == currentObject))
+          || (objectWeAreIn == &hitSurface))
       {
+        //Reflective surface, but reflection wouldn't change the color
+        if (reflectionCoef > 0.0f && reflectionCoef < COLOR_MIN_VALUE
+            && reflecionDeep >= 0)
+        {
+          RENDER_STATS_ADD(stats.earlyTerminations, 1);
+        }
+
         break;
       }
 
@@ -259,6 +810,8 @@ inline void Renderer::shootRay (Ray & ray,
       //ray is still normalized;
 
       currentObject = nullptr;
+      rayStartIntersectDist = -1.0f;
+      reflected = true;
     }
     else
     {
@@ -308,6 +861,9 @@ inline int Renderer::calculateRefraction (Ray &ray,
 
     return 0;
   }
+
+  RENDER_STATS_ADD(stats.totalInternalReflections, 1);
+
   return -1;
 }
 
@@ -348,6 +904,7 @@ inline Color Renderer::shootRefractedRay (const Ray &ray,
       //changing object to the sphere we are going into
       objectWeAreIn = &currentObject;
 
+      RENDER_STATS_ADD(stats.refractionRays, 1);
       shootRay(newRay, transpColor, mainViewDistance, refractionDepth - 1,
                objectWeAreIn);
 
@@ -4,8 +4,11 @@
 
 #include <QScopedPointer>
 #include <QImage>
+#include <vector>
 #include "Controller/GlobalDefines.h"
+#include "Model/Color.h"
 #include "Model/ModelDefines.h"
+#include "Model/RenderStats.h"
 #include "Model/Vector.h"
 
 class QString;
@@ -20,7 +23,6 @@ namespace Controller
 namespace Model
 {
   //Forward declarations -->
-  class Color;
   class Point;
   class VisibleObject;
   class Ray;
@@ -61,6 +63,24 @@ namespace Model
         renderParams = newRenderParams;
       }
 
+      /**Returns render counters collected since last reset
+       * Counters are zero when RENDER_STATS isn't defined.
+       *
+       * @return render counters
+       */
+      inline const RenderStats &getStats () const
+      {
+        return stats;
+      }
+
+      /**Sets render counters to 0
+       *
+       */
+      inline void resetStats ()
+      {
+        stats.reset();
+      }
+
     private:
       //Internal temporary -->
       QScopedPointer <Ray> lightRay;
@@ -76,10 +96,123 @@ namespace Model
        *
        */
       QScopedPointer <Vector> tmpDistance;
+      /**Last object that blocked shadow ray of each light
+       * It's tested before the whole scene
+       *
+       */
+      mutable std::vector <const VisibleObject *> lastOccluders;
+      /**Primary hits and colors of tile with one pixel border
+       * They are used by analytic and adaptive anti-aliasing
+       *
+       */
+      std::vector <const VisibleObject *> tileObjects;
+      std::vector <worldUnit> tileRanges;
+      std::vector <Color> tileColors;
+      std::vector <bool> tileShaded;
       // <-- Internal temporary
 
+      /**Counters of this renderer; renderer is used by one thread only
+       *
+       */
+      mutable RenderStats stats;
+
       const Controller::RenderParams * renderParams;
 
+      /**Renders tile in blocks of pixelStep x pixelStep pixels
+       * One ray is traced through top left corner of each block and
+       * its color fills the whole block. Blocks which have the same
+       * corner as blocks of previous, twice coarser pass already have
+       * their color, so they are skipped.
+       *
+       * @param tile part of image
+       */
+      void renderBlocks (const RenderTileData &tile);
+
+      /**Renders tile with analytic anti-aliasing
+       * Coverage of pixel is estimated from distance of its ray to
+       * silhouettes of objects. Pixel near silhouette of its own object
+       * is blended with color behind the object found by one continuation
+       * ray. Pixel near silhouette of neighbour's object in front is
+       * blended with color of the neighbour.
+       *
+       * @param tile part of image
+       */
+      void renderAnalyticAA (const RenderTileData &tile);
+
+      /**Renders tile with adaptive anti-aliasing
+       * Every pixel is traced once first. Pixels whose neighbours show
+       * other object or differ in color by more than adaptiveAAThreshold
+       * are traced again with adaptiveAASamples stratified samples.
+       *
+       * @param tile part of image
+       */
+      void renderAdaptiveAA (const RenderTileData &tile);
+
+      /**Traces primary rays of tile with one pixel border
+       * Hits are stored in tile buffers, pixels aren't shaded yet.
+       *
+       * @param tile part of image
+       */
+      void traceTileHits (const RenderTileData &tile);
+
+      /**Checks if pixel of tile lies on edge which should be supersampled
+       *
+       * @param x column of pixel in image
+       * @param y line of pixel in image
+       * @param pixelIdx index of pixel in tile buffers
+       * @param width width of tile buffers
+       * @return true if any neighbour shows other object or its color
+       * differs too much
+       */
+      bool isEdgePixel (imageUnit x,
+                        imageUnit y,
+                        size_t pixelIdx,
+                        imageUnit width);
+
+      /**Returns average color of stratified samples of pixel
+       *
+       * @param x column of pixel in image
+       * @param y line of pixel in image
+       * @param gridSize amount of samples on each axis of pixel
+       * @return color of pixel
+       */
+      Color getSupersampledColor (imageUnit x, imageUnit y, int gridSize);
+
+      /**Returns offset of sample in its cell of pixel
+       *
+       * @param x column of pixel in image
+       * @param y line of pixel in image
+       * @param idx index of offset in pixel
+       * @return pseudo random offset in range <0, 1)
+       */
+      float getJitter (imageUnit x, imageUnit y, int idx) const;
+
+      /**Sets primary ray going through given point of image
+       *
+       * @param x column of pixel; it can be fractional or outside of image
+       * @param y line of pixel; it can be fractional or outside of image
+       * @param ray ray to set
+       */
+      void getPrimaryRay (worldUnit x, worldUnit y, Ray &ray) const;
+
+      /**Returns color of pixel of tile shaded by analytic anti-aliasing
+       * Pixel is shaded when its color is needed for the first time.
+       *
+       * @param x column of pixel in image
+       * @param y line of pixel in image
+       * @param pixelIdx index of pixel in tile buffers
+       * @return color of pixel
+       */
+      const Color &getTileColor (imageUnit x, imageUnit y, size_t pixelIdx);
+
+      /**Returns part of pixel covered by object
+       *
+       * @param edgeDistance distance of pixel ray from silhouette
+       * @param depth distance of silhouette from camera screen
+       * @return coverage in range <0, 1>
+       */
+      float getCoverage (worldUnit edgeDistance, worldUnit depth) const;
+
       /**It checks if given ray intersects with any object in scene
        * If there is no intersection with given ray then returned color
        * is equal to default color
@@ -89,12 +222,20 @@ namespace Model
        * @param viewDistance maximum range to check intersections
        * @param refractionDepth maximum depth of refraction
        * @param objectWeAreIn object in which current ray starts
+       * @param firstObject first object hit by ray if it's already known
+       * @param firstDistance distance to firstObject; negative if first
+       *   intersection has to be found
+       * @param viewDependent set to true if color of the first hit depends
+       *   on direction of ray, i.e. surface reflects or refracts it
        */
       void shootRay (Ray & ray,
                      Color &resultColor,
                      worldUnit viewDistance,
                      int refractionDepth,
-                     const VisibleObject *objectWeAreIn) const;
+                     const VisibleObject *objectWeAreIn,
+                     const VisibleObject *firstObject = nullptr,
+                     worldUnit firstDistance = -1.0f,
+                     bool *viewDependent = nullptr) const;
 
       /**Used to calculate color of transparent object; shoots refracted rays
        *
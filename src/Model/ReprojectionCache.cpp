@@ -0,0 +1,88 @@
+/// @file Model/ReprojectionCache.cpp
+
+#include <cmath>
+
+#include "Model/Camera.h"
+#include "Model/ReprojectionCache.h"
+
+//Samples are shaded again after this amount of reused frames, so
+//specular highlights don't stay in old place for long
+#define REPROJECTION_MAX_AGE 16
+
+//Allowed difference of distance of primary hit [px]
+//Neighbouring pixels of surfaces seen at small angle differ a lot
+#define REPROJECTION_DEPTH_TOLERANCE 4.0f
+
+namespace Model
+{
+
+  ReprojectionCache::ReprojectionCache ()
+  {
+    width = 0;
+    height = 0;
+  }
+
+  void ReprojectionCache::resize (imageUnit newWidth, imageUnit newHeight)
+  {
+    width = newWidth;
+    height = newHeight;
+
+    samples.assign(width * height, Sample());
+    reprojected.clear();
+  }
+
+  void ReprojectionCache::clear ()
+  {
+    samples.assign(samples.size(), Sample());
+  }
+
+  size_t ReprojectionCache::reproject (const Camera &camera)
+  {
+    size_t reprojectedCount = 0;
+
+    reprojected.assign(samples.size(), Sample());
+
+    for (const Sample &sample : samples)
+    {
+      worldUnit x, y, distance;
+
+      if (sample.object == nullptr || sample.age >= REPROJECTION_MAX_AGE
+          || !camera.project(sample.hit, x, y, distance))
+      {
+        continue;
+      }
+
+      //Sample goes to pixel whose primary ray is the closest one
+      x = std::floor(x + 0.5f);
+      y = std::floor(y + 0.5f);
+
+      if (x < 0.0f || y < 0.0f || x >= width || y >= height)
+      {
+        continue;
+      }
+
+      Sample &target = reprojected [static_cast <size_t>(y) * width
+          + static_cast <size_t>(x)];
+
+      if (target.object == nullptr)
+      {
+        ++reprojectedCount;
+      }
+      else if (target.distance <= distance)
+      {
+        continue;
+      }
+
+      target = sample;
+      target.distance = distance;
+      target.tolerance = camera.getPixelFootprint(distance)
+          * REPROJECTION_DEPTH_TOLERANCE;
+      ++target.age;
+    }
+
+    samples.swap(reprojected);
+
+    return reprojectedCount;
+  }
+
+} /* namespace Model */
@@ -0,0 +1,160 @@
+/// @file Model/ReprojectionCache.h
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "Controller/GlobalDefines.h"
+#include "Model/Color.h"
+#include "Model/ModelDefines.h"
+#include "Model/Point.h"
+
+namespace Model
+{
+  //Forward declarations -->
+  class Camera;
+  class VisibleObject;
+  // <-- Forward declarations
+
+  /**Primary hits and colors of pixels of previous frames
+   * Hits are kept in 3D space, so after camera is moved they are
+   * projected on the new image and colors of surfaces which are still
+   * visible don't have to be shaded again. Renderer traces primary ray
+   * of each pixel anyway and reuses color only when the ray hits the same
+   * object at about the same distance, so surfaces which were hidden
+   * or out of the image are never covered by wrong samples.
+   *
+   * Each pixel is written only by renderer which renders its tile, other
+   * methods are called when no renderer is running.
+   *
+   */
+  class ReprojectionCache
+  {
+    public:
+      ReprojectionCache ();
+
+      /**Sets size of image and removes all samples
+       *
+       * @param newWidth image width
+       * @param newHeight image height
+       */
+      void resize (imageUnit newWidth, imageUnit newHeight);
+
+      /**Removes all samples
+       * It has to be called when scene or shading parameters are changed.
+       *
+       */
+      void clear ();
+
+      /**Moves samples to pixels of new camera view
+       * When more samples fall into one pixel, the closest one is kept.
+       * Samples which are outside of the image, behind the screen or
+       * were reused REPROJECTION_MAX_AGE times are removed.
+       *
+       * @param camera camera with new position and angles
+       * @return amount of pixels which got sample
+       */
+      size_t reproject (const Camera &camera);
+
+      /**Checks if sample of pixel shows surface hit by its primary ray
+       *
+       * @param pixelIdx index of pixel; x + y * imageWidth
+       * @param object object hit by primary ray
+       * @param distance distance to the hit
+       * @return true if color of sample can be used
+       */
+      inline bool isValid (size_t pixelIdx,
+                           const VisibleObject *object,
+                           worldUnit distance) const
+      {
+        const Sample &sample = samples [pixelIdx];
+
+        return object != nullptr && sample.object == object
+            && std::fabs(distance - sample.distance) <= sample.tolerance;
+      }
+
+      /**Returns color of sample
+       *
+       * @param pixelIdx index of pixel; x + y * imageWidth
+       * @return red, green and blue component
+       */
+      inline const colorType *getColor (size_t pixelIdx) const
+      {
+        return samples [pixelIdx].color;
+      }
+
+      /**Stores primary hit and color of pixel
+       * Pixels without hit or with color which depends on direction
+       * of ray, i.e. reflections and refractions, aren't reused.
+       *
+       * @param pixelIdx index of pixel; x + y * imageWidth
+       * @param object object hit by primary ray; nullptr if there's no hit
+       * @param hit point of the hit
+       * @param color color of pixel
+       * @param reusable false if color can't be reused in other view
+       */
+      inline void store (size_t pixelIdx,
+                         const VisibleObject *object,
+                         const Point &hit,
+                         const Color &color,
+                         bool reusable)
+      {
+        Sample &sample = samples [pixelIdx];
+
+        sample.object = reusable ? object : nullptr;
+        sample.hit = hit;
+        sample.color [0] = color.red();
+        sample.color [1] = color.green();
+        sample.color [2] = color.blue();
+        sample.age = 0;
+      }
+
+      inline imageUnit getWidth () const
+      {
+        return width;
+      }
+
+      inline imageUnit getHeight () const
+      {
+        return height;
+      }
+
+    private:
+      struct Sample
+      {
+          Point hit;
+          /**Object hit by primary ray; nullptr if sample is empty
+           *
+           */
+          const VisibleObject *object;
+          /**Distance from camera screen to hit
+           *
+           */
+          worldUnit distance;
+          /**Maximal difference of distance of primary hit in pixel
+           *
+           */
+          worldUnit tolerance;
+          colorType color [3];
+          /**Amount of frames which reused the sample
+           *
+           */
+          quint8 age;
+
+          inline Sample ()
+              : object(nullptr), distance(0.0f), tolerance(0.0f), age(0)
+          {
+          }
+      };
+
+      std::vector <Sample> samples;
+      /**Samples of new view; it's kept to avoid allocations
+       *
+       */
+      std::vector <Sample> reprojected;
+      imageUnit width;
+      imageUnit height;
+  };
+
+} /* namespace Model */
@@ -136,27 +136,70 @@ namespace Model
         (*this) [Z] = z;
       }
 
+      /**Calculates dot product with the fastest available instructions
+       *
+       * @param other second vector
+       * @return dot product
+       */
       inline float dotProduct (const SSEData &other) const
       {
-        float dotProd;
-        IGNORE_WARNINGS_BEGIN
+#if __SSE4_1__ == 1 &&  USE_SSE == 1
+        return dotProductDP(other);
+#elif __SSE3__ == 1 &&  USE_SSE == 1
+        return dotProductHadd(other);
+#else
+        return dotProductScalar(other);
+#endif
+      }
 
 #if __SSE4_1__ == 1 &&  USE_SSE == 1
+      /**Calculates dot product with _mm_dp_ps
+       *
+       * @param other second vector
+       * @return dot product
+       */
+      inline float dotProductDP (const SSEData &other) const
+      {
+        float dotProd;
+        IGNORE_WARNINGS_BEGIN
         _mm_store_ss(
             &dotProd,
             _mm_dp_ps(const_cast <__m128 &>(data), const_cast <__m128 &>(other.data), DOT_PROD_MASK));
-#elif __SSE3__ == 1 &&  USE_SSE == 1
+        IGNORE_WARNINGS_END
+        return dotProd;
+      }
+#endif
+
+#if __SSE3__ == 1 &&  USE_SSE == 1
+      /**Calculates dot product with multiplication and horizontal adds
+       * W components have to be zeroed
+       *
+       * @param other second vector
+       * @return dot product
+       */
+      inline float dotProductHadd (const SSEData &other) const
+      {
+        float dotProd;
+        IGNORE_WARNINGS_BEGIN
         __m128 result = _mm_mul_ps( const_cast <__m128 &>(data), const_cast <__m128 &>(other.data));
         result = _mm_hadd_ps(result, result);
         result = _mm_hadd_ps(result, result);
         _mm_store_ss(&dotProd, result);
-#else
-        dotProd = (*this) [X] * other [X] + (*this) [Y] * other [Y]
-            + (*this) [Z] * other [Z];
-#endif
         IGNORE_WARNINGS_END
         return dotProd;
       }
+#endif
+
+      /**Calculates dot product without SIMD instructions
+       *
+       * @param other second vector
+       * @return dot product
+       */
+      inline float dotProductScalar (const SSEData &other) const
+      {
+        return (*this) [X] * other [X] + (*this) [Y] * other [Y]
+            + (*this) [Z] * other [Z];
+      }
 
       inline SSEData operator + (const SSEData &other) const
       {
@@ -235,6 +278,42 @@ namespace Model
         return *this * SSEData(other, other, other);
       }
 
+      /**Returns component-wise minimum of this and other
+       *
+       * @param other object to compare with
+       * @return component-wise minimum
+       */
+      inline SSEData min (const SSEData &other) const
+      {
+#if USE_SSE == 1
+        return _mm_min_ps(const_cast <__m128 &>(data),
+            const_cast <__m128 &>(other.data));
+#else
+        return SSEData(
+            (*this) [X] < other [X] ? (*this) [X] : other [X],
+            (*this) [Y] < other [Y] ? (*this) [Y] : other [Y],
+            (*this) [Z] < other [Z] ? (*this) [Z] : other [Z]);
+#endif
+      }
+
+      /**Returns component-wise maximum of this and other
+       *
+       * @param other object to compare with
+       * @return component-wise maximum
+       */
+      inline SSEData max (const SSEData &other) const
+      {
+#if USE_SSE == 1
+        return _mm_max_ps(const_cast <__m128 &>(data),
+            const_cast <__m128 &>(other.data));
+#else
+        return SSEData(
+            (*this) [X] > other [X] ? (*this) [X] : other [X],
+            (*this) [Y] > other [Y] ? (*this) [Y] : other [Y],
+            (*this) [Z] > other [Z] ? (*this) [Z] : other [Z]);
+#endif
+      }
+
       SSEData &operator *= (float other)
       {
 #if USE_SSE == 1
@@ -556,6 +635,28 @@ namespace Model
         return *this;
       }
 
+      /**Returns component-wise minimum of self and other
+       * You should give here Point::data
+       *
+       * @param other SSEVector
+       * @return component-wise minimum
+       */
+      inline SSEVector min (const SSEVector &other) const
+      {
+        return internalData->min(*other.internalData);
+      }
+
+      /**Returns component-wise maximum of self and other
+       * You should give here Point::data
+       *
+       * @param other SSEVector
+       * @return component-wise maximum
+       */
+      inline SSEVector max (const SSEVector &other) const
+      {
+        return internalData->max(*other.internalData);
+      }
+
       /**Calculates dot product of vector with self
        * Result is also stored in squareLength
        *
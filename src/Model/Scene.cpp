@@ -1,15 +1,19 @@
 /// @file Model/Scene.cpp
 
 #include <exception>
+#include <QElapsedTimer>
 #include <QFile>
 
+#include "Model/BoundingBox.h"
 #include "Model/Camera.h"
+#include "Model/CompiledSceneFile.h"
 #include "Model/Light.h"
 #include "Model/Object.h"
 #include "Model/Scene.h"
 #include "Model/SceneFileManager.h"
 #include "Model/Sphere.h"
 #include "Model/Material.h"
+#include "Model/UniformGrid.h"
 
 using namespace std;
 
@@ -17,7 +21,8 @@ namespace Model
 {
 
   Scene::Scene ()
-      : world(1)
+      : world(1), accelerator(new BVH), acceleratorType(Accelerators::Auto), accelerationBuildTime(
+          0)
   {
     loaded = false;
 
@@ -36,14 +41,30 @@ namespace Model
       return loaded;
     }
 
-    if (infile.exists())
+    if (infile.open(QIODevice::ReadOnly))
     {
+      //Old materials keep their textures cached until new scene is loaded
+      MaterialContainer oldMaterials;
+      oldMaterials.swap(materials);
+
       lights.clear();
-      materials.clear();
       objects.clear();
+      unboundedObjects.clear();
+      accelerator->clear();
+      acceleratorType = Accelerators::Auto;
+
+      if (CompiledSceneFile::isCompiledScene(infile))
+      {
+        //Compiled scene has acceleration structure already built
+        CompiledSceneFile::loadScene(infile, *this);
+      }
+      else
+      {
+        SceneFileManager fileManager;
+        fileManager.loadScene(infile, *this);
+        buildAccelerationStructure();
+      }
 
-      SceneFileManager fileManager;
-      fileManager.loadScene(infile, *this);
       infile.close();
       result = true;
 
@@ -53,6 +74,95 @@ namespace Model
     return result;
   }
 
+  void Scene::buildAccelerationStructure ()
+  {
+    ObjectPtrContainer boundedObjects;
+    BoundingBox box;
+
+    unboundedObjects.clear();
+
+    for (const auto &object : objects)
+    {
+      if (object->getBoundingBox(box))
+      {
+        boundedObjects.push_back(object.get());
+      }
+      else
+      {
+        unboundedObjects.push_back(object.get());
+      }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (isGridUsed(boundedObjects))
+    {
+      accelerator.reset(new UniformGrid);
+    }
+    else
+    {
+      accelerator.reset(new BVH);
+    }
+
+    accelerator->build(boundedObjects);
+    accelerationBuildTime = timer.nsecsElapsed();
+  }
+
+  bool Scene::updateAccelerationStructure ()
+  {
+    if (accelerator->refit())
+    {
+      return false;
+    }
+
+    buildAccelerationStructure();
+
+    return true;
+  }
+
+  void Scene::restoreAccelerationStructure (BVH::NodeContainer &&nodes,
+                                            const ObjectPtrContainer &bvhObjects)
+  {
+    BoundingBox box;
+
+    unboundedObjects.clear();
+
+    for (const auto &object : objects)
+    {
+      if (!object->getBoundingBox(box))
+      {
+        unboundedObjects.push_back(object.get());
+      }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    //Stored tree is dropped when scene asks for grid
+    if (isGridUsed(bvhObjects))
+    {
+      accelerator.reset(new UniformGrid);
+      accelerator->build(bvhObjects);
+    }
+    else
+    {
+      std::unique_ptr <BVH> bvh(new BVH);
+
+      bvh->restore(std::move(nodes), bvhObjects);
+      accelerator.reset(bvh.release());
+    }
+
+    accelerationBuildTime = timer.nsecsElapsed();
+  }
+
+  bool Scene::isGridUsed (const ObjectPtrContainer &boundedObjects) const
+  {
+    return acceleratorType == Accelerators::Grid
+        || (acceleratorType == Accelerators::Auto
+            && UniformGrid::isSuitable(boundedObjects));
+  }
+
   void Scene::updateCamera ()
   {
     camera.calibrate();
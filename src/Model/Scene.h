@@ -8,9 +8,12 @@
 
 #include "Controller/GlobalDefines.h"
 #include "Model/ModelDefines.h"
+#include "Model/Accelerator.h"
+#include "Model/BVH.h"
 #include "Model/Camera.h"
 #include "Model/Light.h"
 #include "Model/Material.h"
+#include "Model/RenderStats.h"
 #include "Model/Sphere.h"
 
 //Forward declarations -->
@@ -32,6 +35,7 @@ namespace Model
       typedef std::vector <Light> LighContainer;
       typedef std::vector <Material> MaterialContainer;
       typedef std::vector <VisibleObjectUniquePtr> ObjectContainer;
+      typedef std::vector <const VisibleObject *> ObjectPtrContainer;
 
       /**Sets loaded = false
        *
@@ -78,6 +82,179 @@ namespace Model
         return objects;
       }
 
+      /**Finds closest object which intersects with given ray
+       * Bounded objects are searched in acceleration structure, unbounded
+       * ones are checked
+       * one by one
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param tmpDist temporary vector for calculations
+       * @param stats counters of intersection tests
+       * @return closest intersected object or nullptr if there's no intersection
+       */
+      inline const VisibleObject *findIntersection (const Ray &ray,
+                                                    worldUnit &range,
+                                                    Vector &tmpDist,
+                                                    RenderStats &stats) const
+      {
+        const VisibleObject *closestObject = accelerator->findIntersection(
+            ray, range, tmpDist, stats);
+
+        RENDER_STATS_ADD(stats.intersectionTests, unboundedObjects.size());
+
+        for (const VisibleObject *object : unboundedObjects)
+        {
+          if (object->checkRay(ray, range, tmpDist))
+          {
+            closestObject = object;
+          }
+        }
+
+        return closestObject;
+      }
+
+      /**Finds closest objects which intersect with packet of rays
+       *
+       * @param packet rays to check intersection with
+       * @param hit closest intersections; ranges are shortened on hit
+       * @param stats counters of intersection tests
+       */
+      inline void findIntersections (const RayPacket &packet,
+                                     PacketHit &hit,
+                                     RenderStats &stats) const
+      {
+        accelerator->findIntersections(packet, hit, stats);
+
+        RENDER_STATS_ADD(stats.intersectionTests,
+                         unboundedObjects.size() * packet.rayCount);
+
+        for (const VisibleObject *object : unboundedObjects)
+        {
+          object->checkRays(packet, hit);
+        }
+      }
+
+      /**Checks if there is any object between ray start and maxDist
+       * Object which occluded previous ray is checked first, because
+       * neighbouring shadow rays are usually blocked by the same object.
+       * It's updated when other occluder is found.
+       *
+       * @param ray ray to check intersection with
+       * @param maxDist range of given ray
+       * @param tmpDist temporary vector for calculations
+       * @param lastOccluder cached occluder; may be nullptr
+       * @param stats counters of intersection tests
+       * @return true if ray is occluded, otherwise false
+       */
+      inline bool isOccluded (const Ray &ray,
+                              worldUnit maxDist,
+                              Vector &tmpDist,
+                              const VisibleObject *&lastOccluder,
+                              RenderStats &stats) const
+      {
+        worldUnit range = maxDist;
+
+        if (lastOccluder != nullptr)
+        {
+          RENDER_STATS_ADD(stats.intersectionTests, 1);
+
+          if (lastOccluder->checkRay(ray, range, tmpDist))
+          {
+            return true;
+          }
+        }
+
+        const VisibleObject *occluder = accelerator->findAnyIntersection(
+            ray, maxDist, tmpDist, stats);
+
+        if (occluder == nullptr)
+        {
+          for (const VisibleObject *object : unboundedObjects)
+          {
+            RENDER_STATS_ADD(stats.intersectionTests, 1);
+            range = maxDist;
+            if (object->checkRay(ray, range, tmpDist))
+            {
+              occluder = object;
+              break;
+            }
+          }
+        }
+
+        if (occluder != nullptr)
+        {
+          lastOccluder = occluder;
+          return true;
+        }
+
+        return false;
+      }
+
+      /**Builds acceleration structure over objects in scene
+       * It has to be called after all objects are added to scene.
+       * Type of the structure is set by setAcceleratorType.
+       *
+       */
+      void buildAccelerationStructure ();
+
+      /**Updates acceleration structure after objects were moved or resized
+       * Bounds of BVH are refitted in linear time. The structure is built
+       * again when refitting makes it too slow. Objects can't be added
+       * or removed since the last build.
+       *
+       * @return true if the structure was built again
+       */
+      bool updateAccelerationStructure ();
+
+      /**Restores acceleration structure built earlier
+       * It's used instead of buildAccelerationStructure when scene
+       * is read from compiled scene file. Grid isn't stored, so it's
+       * built when type of the structure asks for it.
+       *
+       * @param nodes nodes of BVH
+       * @param bvhObjects bounded objects ordered as referenced by leaves
+       */
+      void restoreAccelerationStructure (BVH::NodeContainer &&nodes,
+                                         const ObjectPtrContainer &bvhObjects);
+
+      /**Returns acceleration structure over bounded objects
+       *
+       * @return BVH or grid
+       */
+      inline const Accelerator &getAccelerationStructure () const
+      {
+        return *accelerator;
+      }
+
+      /**Sets type of acceleration structure built by
+       * buildAccelerationStructure
+       *
+       * @param type type of structure
+       */
+      inline void setAcceleratorType (Accelerators::AcceleratorType type)
+      {
+        acceleratorType = type;
+      }
+
+      /**Returns type of acceleration structure requested by scene
+       *
+       * @return type of structure; Auto if it's chosen from objects
+       */
+      inline Accelerators::AcceleratorType getAcceleratorType () const
+      {
+        return acceleratorType;
+      }
+
+      /**Returns time of the last build of acceleration structure
+       *
+       * @return time in nanoseconds
+       */
+      inline quint64 getAccelerationBuildTime () const
+      {
+        return accelerationBuildTime;
+      }
+
       /**Returns lights in scene
        *
        * @return lights
@@ -181,11 +358,25 @@ namespace Model
       }
 
     private:
+      /**Checks if grid is built instead of BVH
+       *
+       * @param boundedObjects objects placed in the structure
+       * @return true if grid is used
+       */
+      bool isGridUsed (const ObjectPtrContainer &boundedObjects) const;
+
       Sphere world;
       Camera camera;
       LighContainer lights;
       MaterialContainer materials;
       ObjectContainer objects;
+      /**Objects which can't be placed in BVH e.g. planes
+       *
+       */
+      ObjectPtrContainer unboundedObjects;
+      AcceleratorUniquePtr accelerator;
+      Accelerators::AcceleratorType acceleratorType;
+      quint64 accelerationBuildTime;
       MaterialUniquePtr worldMaterial;
       bool loaded;
   };
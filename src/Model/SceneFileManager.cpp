@@ -1,14 +1,17 @@
 /// @file Model/SceneFileManager.cpp
 
 #include <QIODevice>
-#include <QtXml>
+#include <QXmlStreamReader>
 #include <stdexcept>
 
 #include "Model/Camera.h"
+#include "Model/GroupInstance.h"
+#include "Model/LatticeSphere.h"
 #include "Model/Light.h"
 #include "Model/Material.h"
 #include "Model/ModelDefines.h"
 #include "Model/Object.h"
+#include "Model/ObjectGroup.h"
 #include "Model/Plane.h"
 #include "Model/Scene.h"
 #include "Model/SceneFileManager.h"
@@ -19,39 +22,123 @@ using namespace Model;
 
 void SceneFileManager::loadScene (QIODevice & io, Scene &scene)
 {
-  Objects::ObjectType objectType = Objects::None;
-  QString tmpname;
-  QDomNode node;
-  QDomElement root;
-  QDomDocument d;
-  bool cameraExists = false;
+  QXmlStreamReader reader(&io);
 
-  d.setContent(&io);
-  root = d.documentElement();
+  try
+  {
+    //Sections are children of the root element
+    if (reader.readNextStartElement())
+    {
+      loadAccelerator(reader.attributes(), scene);
 
-  // Loading maerials
-  tmpname = Materials::MATERIALS_NAME;
-  node = root.elementsByTagName(tmpname).item(0).firstChild();
+      while (reader.readNextStartElement())
+      {
+        //Only the first section of each kind is loaded
+        if (reader.name() == Materials::MATERIALS_NAME && !materialsLoaded)
+        {
+          loadMaterials(reader, scene);
+        }
+        else if (reader.name() == Lights::LIGHTS_NAME && !lightsLoaded)
+        {
+          loadLights(reader, scene);
+        }
+        else if (reader.name() == Groups::GROUPS_NAME && !groupsLoaded)
+        {
+          loadGroups(reader, scene);
+        }
+        else if (reader.name() == Objects::OBJECTS_NAME && !objectsLoaded)
+        {
+          loadObjects(reader, scene);
+        }
+        else
+        {
+          reader.skipCurrentElement();
+        }
+      }
+    }
 
-  for (; !node.isNull(); node = node.nextSibling())
+    if (reader.hasError())
+      throw std::logic_error(
+          "Błąd składni XML: " + reader.errorString().toStdString());
+  }
+  catch (std::logic_error &ex)
   {
-    if (!node.isElement())
-      continue;
+    throw std::logic_error(
+        QString("Linia %1, kolumna %2: ").arg(reader.lineNumber()).arg(
+            reader.columnNumber()).toStdString() + ex.what());
+  }
+
+  if (scene.getMaterials().empty())
+    throw std::logic_error("Brak zdefiniowanych materiałów");
+
+  //Objects read before materials get them now
+  for (const MaterialLink &link : materialLinks)
+  {
+    if (link.second >= scene.getMaterials().size())
+      throw std::logic_error("Nie ma takiego materiału. Sprawdź obiekty.");
+
+    link.first->setMaterial( &scene.getMaterials() [link.second]);
+  }
+
+  materialLinks.clear();
+  groups.clear();
+
+  if (!cameraExists)
+  {
+    throw std::logic_error("Brak kamery w scenie");
+  }
+
+  if (scene.getLights().empty())
+  {
+    throw std::logic_error("Brak świateł w scenie");
+  }
+}
+
+void SceneFileManager::loadAccelerator (const QXmlStreamAttributes &elem,
+                                        Scene &scene)
+{
+  QString accelerator = elem.value(Accelerators::ACCELERATOR_NAME).toString()
+      .toLower();
+
+  if (accelerator.isEmpty() || accelerator == Accelerators::AUTO_NAME)
+  {
+    scene.setAcceleratorType(Accelerators::Auto);
+  }
+  else if (accelerator == Accelerators::BVH_NAME)
+  {
+    scene.setAcceleratorType(Accelerators::Hierarchy);
+  }
+  else if (accelerator == Accelerators::GRID_NAME)
+  {
+    scene.setAcceleratorType(Accelerators::Grid);
+  }
+  else
+  {
+    throw std::logic_error(
+        "Nieznana struktura przyspieszająca. Dostępne: auto, bvh, grid.");
+  }
+}
+
+void SceneFileManager::loadMaterials (QXmlStreamReader &reader, Scene &scene)
+{
+  ChildContainer children;
 
+  while (reader.readNextStartElement())
+  {
     Material material;
     Color color, specularColor;
     float specularPower, reflection, ior, transparency;
 
-    QDomElement elem = node.toElement();
+    QXmlStreamAttributes elem = reader.attributes();
+    readChildren(reader, children);
 
     reflection = getFloat(elem, "reflection");
     ior = getFloat(elem, "ior");
     transparency = getFloat(elem, "transparency");
     specularPower = getFloat(elem, "specularPower");
-    getColor(node.firstChildElement("diffuseColor").toElement(), color);
-    getColor(node.firstChildElement("specularColor").toElement(),
-             specularColor);
-    QString texture = elem.attribute("texture");
+    getColor(getChild(children, "diffuseColor"), color);
+    getColor(getChild(children, "specularColor"), specularColor);
+    QString texture = elem.value("texture").toString();
 
     if (reflection < 0.0f || reflection > 1.0f)
       throw std::logic_error("Wartość odbicia jest spoza zakresu.");
@@ -76,246 +163,409 @@ void SceneFileManager::loadScene (QIODevice & io, Scene &scene)
     scene.addMaterial(std::move(material));
   }
 
-  if (scene.getMaterials().empty())
-    throw std::logic_error("Brak zdefiniowanych materiałów");
+  //Objects keep pointers to materials, so no more materials can be added
+  materialsLoaded = true;
+}
 
-  // Loading lights
-  tmpname = Lights::LIGHTS_NAME;
-  node = root.elementsByTagName(tmpname).item(0).firstChild();
+void SceneFileManager::loadLights (QXmlStreamReader &reader, Scene &scene)
+{
+  ChildContainer children;
 
-  for (; !node.isNull(); node = node.nextSibling())
+  while (reader.readNextStartElement())
   {
-    if (!node.isElement())
-      continue;
-
     Point point;
     Color color;
     float power;
-    QDomElement elem = node.toElement();
+
+    QXmlStreamAttributes elem = reader.attributes();
+    readChildren(reader, children);
 
     power = static_cast <float>(getFloat(elem, "power"));
     if (power < 0.0f)
       throw std::logic_error("Moc światła nie może być ujemna.");
 
-    getColor(node.firstChildElement("color").toElement(), color);
-    getVPCommon(node.firstChildElement("position").toElement(), point);
+    getColor(getChild(children, "color"), color);
+    getVPCommon(getChild(children, "position"), point);
 
     scene.addLight(Light(point, color, power));
   }
 
-  // Loading objects
-  tmpname = Objects::OBJECTS_NAME;
-  node = root.elementsByTagName(tmpname).item(0).firstChild();
+  lightsLoaded = true;
+}
+
+void SceneFileManager::loadGroups (QXmlStreamReader &reader, Scene &scene)
+{
+  Objects::ObjectType objectType = Objects::None;
+  ChildContainer children;
 
-  for (; !node.isNull(); node = node.nextSibling())
+  while (reader.readNextStartElement())
   {
-    if (!node.isElement())
+    if (reader.name() != Groups::GROUP_NAME)
+    {
+      reader.skipCurrentElement();
       continue;
+    }
 
-    QDomElement elem = node.toElement();
-    objectType = Object::getObjectType(elem.tagName());
+    QString name = reader.attributes().value("name").toString();
 
-    switch (objectType)
+    if (name.isEmpty())
+      throw std::logic_error("Grupa musi mieć nazwę.");
+
+    if (groups.find(name) != groups.end())
+      throw std::logic_error("Grupa o tej nazwie jest już zdefiniowana.");
+
+    std::shared_ptr <ObjectGroup> group(new ObjectGroup());
+
+    while (reader.readNextStartElement())
     {
-      case Objects::Sphere:
-      {
-        std::shared_ptr <Sphere> mainbject;
-        Point point;
-        worldUnit radius, offset;
-        unsigned material;
-        int multiplyX = 1, multiplyY = 1, multiplyZ = 1;
-        int multiplyXSign = 1, multiplyYSign = 1, multiplyZSign = 1;
+      objectType = Object::getObjectType(reader.name().toString());
+      QXmlStreamAttributes elem = reader.attributes();
+      readChildren(reader, children);
 
-        getVPCommon(node.firstChildElement("position").toElement(), point);
-        radius = getFloat(elem, "r");
+      VisibleObjectUniquePtr object;
 
-        if (! (radius > 0))
-        {
-          throw std::logic_error("Promień musi być dodatni.");
-        }
+      switch (objectType)
+      {
+        case Objects::Sphere:
+          object = loadSphere(elem, children, scene);
+          break;
 
-        offset = radius * 2;
-        if (elem.hasAttribute("offset"))
-        {
-          offset = static_cast <worldUnit>(getFloat(elem, "offset"));
-        }
+        case Objects::Plane:
+          object = loadPlane(elem, scene);
+          break;
 
-        material = getInt(elem, "material");
+        default:
+          break;
+      }
 
-        if (material >= scene.getMaterials().size())
-          throw std::logic_error("Nie ma takiego materiału. Sprawdź obiekty.");
+      if (object && !group->addObject(std::move(object)))
+        throw std::logic_error(
+            "Grupa może zawierać tylko ograniczone obiekty (bez płaszczyzn).");
+    }
 
-        QDomNode mul = node.firstChildElement("multiply");
-        if (mul.isElement())
-        {
-          QDomElement mulelem = mul.toElement();
-          multiplyX = getInt(mulelem, "x");
-          multiplyY = getInt(mulelem, "y");
-          multiplyZ = getInt(mulelem, "z");
-        }
+    if (group->getObjects().empty())
+      throw std::logic_error("Grupa nie zawiera żadnych obiektów.");
 
-        mainbject = std::shared_ptr <Sphere>(new Sphere(radius));
-        mainbject->setPosition(point);
-        mainbject->setMaterial(&scene.getMaterials() [material]);
+    group->build();
+    groups [name] = group;
+  }
 
-        if (multiplyX < 0)
-        {
-          multiplyXSign = -1;
-          multiplyX = -multiplyX;
-        }
+  groupsLoaded = true;
+}
 
-        if (multiplyY < 0)
-        {
-          multiplyYSign = -1;
-          multiplyY = -multiplyY;
-        }
+void SceneFileManager::loadObjects (QXmlStreamReader &reader, Scene &scene)
+{
+  Objects::ObjectType objectType = Objects::None;
+  ChildContainer children;
 
-        if (multiplyZ < 0)
-        {
-          multiplyZSign = -1;
-          multiplyZ = -multiplyZ;
-        }
+  while (reader.readNextStartElement())
+  {
+    objectType = Object::getObjectType(reader.name().toString());
+    QXmlStreamAttributes elem = reader.attributes();
+    readChildren(reader, children);
 
-        for (int i = 0; i < multiplyX; ++i)
-        {
-          for (int j = 0; j < multiplyY; ++j)
-          {
-            for (int k = 0; k < multiplyZ; ++k)
-            {
-              std::unique_ptr <VisibleObject> object(new Sphere(*mainbject));
-              point = object->getPosition();
-
-              point [X] += offset * i * multiplyXSign;
-              point [Y] += offset * j * multiplyYSign;
-              point [Z] += offset * k * multiplyZSign;
-
-              object->setPosition(point);
-
-              scene.addVisibleObject(std::move(object));
-            }
-          }
-        }
-      }
+    VisibleObjectUniquePtr object;
+
+    switch (objectType)
+    {
+      case Objects::Sphere:
+        object = loadSphere(elem, children, scene);
         break;
 
       case Objects::Plane:
-      {
-        std::unique_ptr <Plane> object(new Plane());
-        Vector angles;
-        int material;
-
-        angles [X] = getFloat(elem, "angleX");
-        angles [Y] = getFloat(elem, "angleY");
-        angles [Z] = getFloat(elem, "angleZ");
-        angles.length = getFloat(elem, "d");
-        material = getInt(elem, "material");
-
-        object->setAngles(angles);
-        object->setMaterial(&scene.getMaterials() [material]);
-        scene.addVisibleObject(std::move(object));
-      }
+        object = loadPlane(elem, scene);
+        break;
+
+      case Objects::Instance:
+        object = loadInstance(elem, children);
         break;
 
       case Objects::Camera:
-      {
-        if (cameraExists)
-        {
-          throw std::logic_error("Może być zdefiniowana tylko jedna kamera.");
-        }
-        cameraExists = true;
-
-        Camera object;
-        Point point;
-        Vector vector;
-        Point::dataType screenWidth;
-        worldUnit viewDistance;
-        Camera::unitType FOV;
-        QString cameraType;
-
-        getVPCommon(node.firstChildElement("direction").toElement(), vector);
-        getVPCommon(node.firstChildElement("position").toElement(), point);
-
-        screenWidth = static_cast <Point::dataType>(getFloat(elem,
-                                                             "screenWidth"));
-        if (! (screenWidth > 0))
-          throw std::logic_error("Parametr screenWidth musi być większy od 0.");
-
-        FOV = static_cast <Camera::unitType>(getDouble(elem, "fov"));
-        if (! (FOV > 0 && FOV < 180))
-          throw std::logic_error("Parametr FOV musi być z zakresu (0;180).");
-
-        viewDistance = static_cast <worldUnit>(getFloat(elem, "viewDistance"));
-        if (! (viewDistance > 0))
-          throw std::logic_error(
-              "Parametr viewDistance musi być większy od 0.");
-
-        cameraType = elem.attribute("type");
-        object.setFOV(FOV);
-        object.setViewDistance(viewDistance);
-        object.setScreenWidth(screenWidth);
-        object.setPosition(point);
-        object.setAngles(vector);
-        object.setType(cameraType);
-
-        scene.setCamera(std::move(object));
-      }
+        loadCamera(elem, children, scene);
         break;
+
       default:
         break;
     }
+
+    if (object)
+    {
+      scene.addVisibleObject(std::move(object));
+    }
   }
 
-  if (!cameraExists)
+  objectsLoaded = true;
+}
+
+VisibleObjectUniquePtr SceneFileManager::loadSphere (const QXmlStreamAttributes &elem,
+                                                     const ChildContainer &children,
+                                                     Scene &scene)
+{
+  Point point;
+  worldUnit radius, offset;
+  unsigned material;
+  int counts [3] =
+    { 1, 1, 1 };
+  const Axis axes [3] =
+    { X, Y, Z };
+
+  getVPCommon(getChild(children, "position"), point);
+  radius = getFloat(elem, "r");
+
+  if (! (radius > 0))
   {
-    throw std::logic_error("Brak kamery w scenie");
+    throw std::logic_error("Promień musi być dodatni.");
   }
 
-  if (scene.getLights().empty())
+  offset = radius * 2;
+  if (elem.hasAttribute("offset"))
   {
-    throw std::logic_error("Brak świateł w scenie");
+    offset = static_cast <worldUnit>(getFloat(elem, "offset"));
+  }
+
+  material = getInt(elem, "material");
+
+  if (materialsLoaded && material >= scene.getMaterials().size())
+    throw std::logic_error("Nie ma takiego materiału. Sprawdź obiekty.");
+
+  const QXmlStreamAttributes &mulelem = getChild(children, "multiply");
+  if (!mulelem.isEmpty())
+  {
+    counts [0] = getInt(mulelem, "x");
+    counts [1] = getInt(mulelem, "y");
+    counts [2] = getInt(mulelem, "z");
+  }
+
+  //Sphere is copied multiply times on each axis, negative value copies it
+  //towards negative side of the axis
+  Point first(point);
+
+  if (offset < 0)
+  {
+    offset = -offset;
+    for (int &count : counts)
+    {
+      count = -count;
+    }
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (counts [i] < 0)
+    {
+      counts [i] = -counts [i];
+      first [axes [i]] -= offset * (counts [i] - 1);
+    }
+
+    if (counts [i] == 0)
+    {
+      return VisibleObjectUniquePtr();
+    }
+  }
+
+  std::unique_ptr <VisibleObject> object;
+
+  //Copies in the same place would be hidden by the first one
+  if (offset == 0 || (counts [0] == 1 && counts [1] == 1 && counts [2] == 1))
+  {
+    object.reset(new Sphere(radius));
+  }
+  else
+  {
+    object.reset(
+        new LatticeSphere(radius, offset, counts [0], counts [1], counts [2]));
+  }
+
+  object->setPosition(first);
+  setMaterial( *object, material, scene);
+
+  return object;
+}
+
+VisibleObjectUniquePtr SceneFileManager::loadPlane (const QXmlStreamAttributes &elem,
+                                                    Scene &scene)
+{
+  std::unique_ptr <Plane> object(new Plane());
+  Vector angles;
+  int material;
+
+  angles [X] = getFloat(elem, "angleX");
+  angles [Y] = getFloat(elem, "angleY");
+  angles [Z] = getFloat(elem, "angleZ");
+  angles.length = getFloat(elem, "d");
+  material = getInt(elem, "material");
+
+  object->setAngles(angles);
+  setMaterial( *object, material, scene);
+
+  return VisibleObjectUniquePtr(object.release());
+}
+
+VisibleObjectUniquePtr SceneFileManager::loadInstance (const QXmlStreamAttributes &elem,
+                                                       const ChildContainer &children)
+{
+  Point point;
+  Vector angles;
+  worldUnit scale = 1.0f;
+
+  auto group = groups.find(elem.value("group").toString());
+  if (group == groups.end())
+    throw std::logic_error(
+        "Nie ma takiej grupy. Grupy muszą być zdefiniowane przed obiektami.");
+
+  if (elem.hasAttribute("scale"))
+  {
+    scale = getFloat(elem, "scale");
+  }
+
+  if (! (scale > 0))
+    throw std::logic_error("Skala instancji musi być dodatnia.");
+
+  angles [X] = elem.hasAttribute("angleX") ? getFloat(elem, "angleX") : 0.0f;
+  angles [Y] = elem.hasAttribute("angleY") ? getFloat(elem, "angleY") : 0.0f;
+  angles [Z] = elem.hasAttribute("angleZ") ? getFloat(elem, "angleZ") : 0.0f;
+  getVPCommon(getChild(children, "position"), point);
+
+  std::unique_ptr <GroupInstance> object(new GroupInstance(group->second));
+  object->setTransform(angles, scale);
+  object->setPosition(point);
+
+  return VisibleObjectUniquePtr(object.release());
+}
+
+void SceneFileManager::loadCamera (const QXmlStreamAttributes &elem,
+                                   const ChildContainer &children,
+                                   Scene &scene)
+{
+  if (cameraExists)
+  {
+    throw std::logic_error("Może być zdefiniowana tylko jedna kamera.");
+  }
+  cameraExists = true;
+
+  Camera object;
+  Point point;
+  Vector vector;
+  Point::dataType screenWidth;
+  worldUnit viewDistance;
+  Camera::unitType FOV;
+  QString cameraType;
+
+  getVPCommon(getChild(children, "direction"), vector);
+  getVPCommon(getChild(children, "position"), point);
+
+  screenWidth = static_cast <Point::dataType>(getFloat(elem, "screenWidth"));
+  if (! (screenWidth > 0))
+    throw std::logic_error("Parametr screenWidth musi być większy od 0.");
+
+  FOV = static_cast <Camera::unitType>(getDouble(elem, "fov"));
+  if (! (FOV > 0 && FOV < 180))
+    throw std::logic_error("Parametr FOV musi być z zakresu (0;180).");
+
+  viewDistance = static_cast <worldUnit>(getFloat(elem, "viewDistance"));
+  if (! (viewDistance > 0))
+    throw std::logic_error("Parametr viewDistance musi być większy od 0.");
+
+  cameraType = elem.value("type").toString();
+  object.setFOV(FOV);
+  object.setViewDistance(viewDistance);
+  object.setScreenWidth(screenWidth);
+  object.setPosition(point);
+  object.setAngles(vector);
+  object.setType(cameraType);
+
+  scene.setCamera(std::move(object));
+}
+
+void SceneFileManager::setMaterial (VisibleObject &object,
+                                    unsigned material,
+                                    Scene &scene)
+{
+  if (!materialsLoaded)
+  {
+    materialLinks.push_back(MaterialLink( &object, material));
+    return;
+  }
+
+  if (material >= scene.getMaterials().size())
+    throw std::logic_error("Nie ma takiego materiału. Sprawdź obiekty.");
+
+  object.setMaterial( &scene.getMaterials() [material]);
+}
+
+void SceneFileManager::readChildren (QXmlStreamReader &reader,
+                                     ChildContainer &children)
+{
+  children.clear();
+
+  while (reader.readNextStartElement())
+  {
+    children.push_back(
+        ChildAttributes(reader.name().toString(), reader.attributes()));
+    reader.skipCurrentElement();
+  }
+}
+
+const QXmlStreamAttributes &SceneFileManager::getChild (const ChildContainer &children,
+                                                        const QString &name)
+{
+  static const QXmlStreamAttributes noAttributes;
+
+  for (const ChildAttributes &child : children)
+  {
+    if (child.first == name)
+    {
+      return child.second;
+    }
   }
+
+  return noAttributes;
 }
 
-void SceneFileManager::getColor (const QDomElement & value, Color &color)
+void SceneFileManager::getColor (const QXmlStreamAttributes & value,
+                                 Color &color)
 {
   color.setColor(getInt(value, "r"), getInt(value, "g"), getInt(value, "b"));
 }
 
-void SceneFileManager::getVPCommon (const QDomElement & value, SSEVector &object)
+void SceneFileManager::getVPCommon (const QXmlStreamAttributes & value,
+                                    SSEVector &object)
 {
   object [X] = getFloat(value, "x");
   object [Y] = getFloat(value, "y");
   object [Z] = getFloat(value, "z");
 }
 
-int SceneFileManager::getInt (const QDomElement &elem, const QString &name)
+int SceneFileManager::getInt (const QXmlStreamAttributes &elem,
+                              const QString &name)
 {
   bool ok;
   int val;
-  val = elem.attribute(name).toInt(&ok, 10);
+  val = elem.value(name).toString().toInt(&ok, 10);
   if (!ok)
     throw std::logic_error(
         "Błąd podczas wczytywania elementu " + name.toStdString());
   return val;
 }
 
-float SceneFileManager::getFloat (const QDomElement &elem, const QString &name)
+float SceneFileManager::getFloat (const QXmlStreamAttributes &elem,
+                                  const QString &name)
 {
   bool ok;
   float val;
-  val = elem.attribute(name).toFloat(&ok);
+  val = elem.value(name).toString().toFloat(&ok);
   if (!ok)
     throw std::logic_error(
         "Błąd podczas wczytywania elementu " + name.toStdString());
   return val;
 }
 
-double SceneFileManager::getDouble (const QDomElement &elem,
+double SceneFileManager::getDouble (const QXmlStreamAttributes &elem,
                                     const QString &name)
 {
   bool ok;
   double val;
-  val = elem.attribute(name).toDouble(&ok);
+  val = elem.value(name).toString().toDouble(&ok);
   if (!ok)
     throw std::logic_error(
         "Błąd podczas wczytywania elementu " + name.toStdString());
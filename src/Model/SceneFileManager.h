@@ -2,30 +2,49 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QString>
+#include <QXmlStreamAttributes>
+
 #include "Controller/GlobalDefines.h"
+#include "Model/ModelDefines.h"
 
-class QDomElement;
-class QString;
+class QIODevice;
+class QXmlStreamReader;
 
 namespace Model
 {
   //Forward declarations -->
   class Color;
+  class ObjectGroup;
   class SSEVector;
   class Scene;
+  class VisibleObject;
   // <-- Forward declarations
 
   /**Scene loader class
+   * Scene file is parsed in one pass with streaming reader, so no document
+   * tree is built. Materials, lights and objects are put into scene
+   * as soon as they are read. Groups of objects are kept by name until
+   * the whole file is read; instances in objects section place them
+   * in scene, so groups section has to be before objects section.
    *
    */
   class SceneFileManager
   {
     public:
       inline SceneFileManager ()
+          : materialsLoaded(false), lightsLoaded(false), groupsLoaded(false), objectsLoaded(
+              false), cameraExists(false)
       {
       }
 
       /**Loads scene from stream
+       * Errors found while parsing are reported with line and column.
        *
        * @param io stream to load data from
        * @param scene scene to load data in
@@ -33,40 +52,178 @@ namespace Model
       void loadScene (QIODevice & io, Scene &scene);
 
     private:
+      /**Attributes of child element
+       *
+       */
+      typedef std::pair <QString, QXmlStreamAttributes> ChildAttributes;
+      typedef std::vector <ChildAttributes> ChildContainer;
+
+      /**Object which has to get material after all materials are loaded
+       *
+       */
+      typedef std::pair <VisibleObject *, unsigned> MaterialLink;
+      typedef std::vector <MaterialLink> MaterialLinkContainer;
+
+      /**Groups by their names
+       *
+       */
+      typedef std::map <QString, std::shared_ptr <const ObjectGroup> > GroupContainer;
+
+      bool materialsLoaded;
+      bool lightsLoaded;
+      bool groupsLoaded;
+      bool objectsLoaded;
+      bool cameraExists;
+
+      /**Objects read before materials section
+       *
+       */
+      MaterialLinkContainer materialLinks;
+
+      /**Groups loaded from groups section
+       *
+       */
+      GroupContainer groups;
+
+      /**Sets acceleration structure chosen by attribute of root element
+       *
+       * @param attributes attributes of root element
+       * @param scene scene to set structure of
+       */
+      void loadAccelerator (const QXmlStreamAttributes &attributes,
+                            Scene &scene);
+
+      /**Loads all materials from materials section
+       *
+       * @param reader reader placed at start of the section
+       * @param scene scene to load data in
+       */
+      void loadMaterials (QXmlStreamReader &reader, Scene &scene);
+
+      /**Loads all lights from lights section
+       *
+       * @param reader reader placed at start of the section
+       * @param scene scene to load data in
+       */
+      void loadLights (QXmlStreamReader &reader, Scene &scene);
+
+      /**Loads all groups from groups section
+       * Group can contain only bounded objects, so planes are rejected.
+       *
+       * @param reader reader placed at start of the section
+       * @param scene scene with materials
+       */
+      void loadGroups (QXmlStreamReader &reader, Scene &scene);
+
+      /**Loads all objects and camera from objects section
+       *
+       * @param reader reader placed at start of the section
+       * @param scene scene to load data in
+       */
+      void loadObjects (QXmlStreamReader &reader, Scene &scene);
+
+      /**Loads sphere; multiplied sphere is loaded as one lattice of spheres
+       *
+       * @param attributes attributes of sphere element
+       * @param children attributes of child elements
+       * @param scene scene with materials
+       * @return loaded sphere; empty if sphere is multiplied zero times
+       */
+      VisibleObjectUniquePtr loadSphere (const QXmlStreamAttributes &attributes,
+                                         const ChildContainer &children,
+                                         Scene &scene);
+
+      /**Loads plane
+       *
+       * @param attributes attributes of plane element
+       * @param scene scene with materials
+       * @return loaded plane
+       */
+      VisibleObjectUniquePtr loadPlane (const QXmlStreamAttributes &attributes,
+                                        Scene &scene);
+
+      /**Loads instance of group defined in groups section
+       *
+       * @param attributes attributes of instance element
+       * @param children attributes of child elements
+       * @return loaded instance
+       */
+      VisibleObjectUniquePtr loadInstance (const QXmlStreamAttributes &attributes,
+                                           const ChildContainer &children);
+
+      /**Loads camera; there can be only one camera
+       *
+       * @param attributes attributes of camera element
+       * @param children attributes of child elements
+       * @param scene scene to load data in
+       */
+      void loadCamera (const QXmlStreamAttributes &attributes,
+                       const ChildContainer &children,
+                       Scene &scene);
+
+      /**Sets material of object or postpones it until materials are loaded
+       *
+       * @param object object to set material of
+       * @param material index of material
+       * @param scene scene with materials
+       */
+      void setMaterial (VisibleObject &object, unsigned material, Scene &scene);
+
+      /**Reads attributes of all child elements of current element
+       * Reader is moved to the end of current element.
+       *
+       * @param reader reader placed at start of element
+       * @param children attributes of child elements in document order
+       */
+      static void readChildren (QXmlStreamReader &reader,
+                                ChildContainer &children);
+
+      /**Returns attributes of the first child element with given name
+       *
+       * @param children attributes of child elements
+       * @param name name of child element
+       * @return attributes; empty if there is no such child
+       */
+      static const QXmlStreamAttributes &getChild (const ChildContainer &children,
+                                                   const QString &name);
+
       /**Loads color from value to color object
        *
-       * @param value xml value
+       * @param value attributes of xml element
        * @param color color object
        */
-      static void getColor (const QDomElement &value, Color &color);
+      static void getColor (const QXmlStreamAttributes &value, Color &color);
 
       /**Loads data from value to Point object
        * Point is class with common data for Vector and Point
        *
-       * @param value xml value
+       * @param value attributes of xml element
        * @param object object to load data in
        */
-      static void getVPCommon (const QDomElement &value, SSEVector &object);
+      static void getVPCommon (const QXmlStreamAttributes &value,
+                               SSEVector &object);
 
       /** Loads integer data from an xml element to the name variable
        *
-       * @param elem an xml element
+       * @param elem attributes of xml element
        * @param name a name of the xml property to load data from
        */
-      static int getInt (const QDomElement &elem, const QString &name);
+      static int getInt (const QXmlStreamAttributes &elem, const QString &name);
 
       /** Loads floating point data from an xml element to the name variable
        *
-       * @param elem an xml element
+       * @param elem attributes of xml element
        * @param name a name of the xml property to load data from
        */
-      static float getFloat (const QDomElement &elem, const QString &name);
+      static float getFloat (const QXmlStreamAttributes &elem,
+                             const QString &name);
 
       /** Loads double precision floating point data from an xml element to the name variable
        *
-       * @param elem an xml element
+       * @param elem attributes of xml element
        * @param name a name of the xml property to load data from
        */
-      static double getDouble (const QDomElement &elem, const QString &name);
+      static double getDouble (const QXmlStreamAttributes &elem,
+                               const QString &name);
   };
 } /* namespace Model */
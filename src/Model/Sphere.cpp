@@ -1,8 +1,11 @@
 /// @file Model/Sphere.cpp
 
+#include <algorithm>
 #include <cmath>
 
+#include "Model/BoundingBox.h"
 #include "Model/Ray.h"
+#include "Model/RayPacket.h"
 #include "Model/Sphere.h"
 
 namespace Model
@@ -26,39 +29,82 @@ namespace Model
     normalAtPoint.normalize();
   }
 
+  bool Sphere::getBoundingBox (BoundingBox &box) const
+  {
+    Point extent(size, size, size);
+
+    box = BoundingBox(position - extent, position + extent);
+
+    return true;
+  }
+
   bool Sphere::checkRay (const Ray& ray, worldUnit& range, Vector& dist) const
   {
-    dist = position.diff(ray.getStart());
+    return checkRay(position, squareRadius, ray, range, dist);
+  }
 
+  bool Sphere::getSilhouette (const Ray &ray,
+                              worldUnit,
+                              worldUnit &edgeDistance,
+                              worldUnit &depth,
+                              worldUnit &exitDistance) const
+  {
+    Vector dist = position.diff(ray.getStart());
     worldUnit a = ray.getDir().dotProduct(dist);
+    worldUnit squareLength = dist.dotProduct();
 
-    auto squareLength = dist.dotProduct();
-    worldUnit D = squareRadius - squareLength + a * a;
-
-    //There is no intersection with sphere if D < 0
-    if (D < 0.f)
+    if (a <= 0.0f || squareLength <= squareRadius)
     {
       return false;
     }
 
-    worldUnit t = SQRT(D);
+    //Square of closest miss distance, checkRay has D = squareRadius - it
+    worldUnit squareMiss = std::max(squareLength - a * a, 0.0f);
 
-    if (squareLength >= squareRadius)
-    { //We are outside sphere
-      a -= t;
-    }
-    else
-    { //We are inside sphere
-      a += t;
-    }
+    edgeDistance = SQRT(squareMiss) - size;
+    depth = a;
+    exitDistance = a + SQRT(std::max(squareRadius - squareMiss, 0.0f));
 
-    if ( (a > 0.0f) && (a < range))
+    return true;
+  }
+
+  void Sphere::checkRays (const RayPacket &packet, PacketHit &hit) const
+  {
+    PacketFloat distX = packetSub(packetSet(position [X]), packet.startX);
+    PacketFloat distY = packetSub(packetSet(position [Y]), packet.startY);
+    PacketFloat distZ = packetSub(packetSet(position [Z]), packet.startZ);
+
+    PacketFloat a = packetAdd(
+        packetAdd(packetMul(packet.dirX, distX), packetMul(packet.dirY, distY)),
+        packetMul(packet.dirZ, distZ));
+
+    PacketFloat squareLength = packetAdd(
+        packetAdd(packetMul(distX, distX), packetMul(distY, distY)),
+        packetMul(distZ, distZ));
+
+    PacketFloat squareRadiusPacket = packetSet(squareRadius);
+    PacketFloat D = packetAdd(packetSub(squareRadiusPacket, squareLength),
+                              packetMul(a, a));
+
+    //There is no intersection with sphere if D < 0
+    PacketFloat zero = packetSet(0.0f);
+    PacketFloat mask = packetLessEqual(zero, D);
+
+    if (packetMask(mask) == 0)
     {
-      range = a;
-      return true;
+      return;
     }
 
-    return false;
+    PacketFloat t = packetSqrt(packetMax(D, zero));
+
+    //Rays starting outside sphere take closer intersection
+    PacketFloat outside = packetLessEqual(squareRadiusPacket, squareLength);
+    a = packetSelect(packetAdd(a, t), packetSub(a, t), outside);
+
+    mask = packetAnd(mask, packetLess(zero, a));
+    mask = packetAnd(mask, packetLess(a, hit.range));
+
+    hit.update(a, mask, this);
   }
 
 }
@@ -37,6 +37,13 @@ namespace Model
        */
       virtual void getNormal (const Point& point, Vector &normalAtPoint) const;
 
+      /**Calculates bounding box of the sphere
+       *
+       * @param box box to calculate bounds in
+       * @return always true
+       */
+      virtual bool getBoundingBox (BoundingBox &box) const;
+
       /**Checks if given ray intersects with sphere
        *
        * @param ray ray to check intersection with
@@ -48,6 +55,90 @@ namespace Model
                              worldUnit &range,
                              Vector &tmpDist) const;
 
+      /**Checks intersections of packet of rays with sphere
+       * All rays are tested at once with SIMD arithmetic
+       *
+       * @param packet rays to check intersection with
+       * @param hit closest intersections found so far
+       */
+      virtual void checkRays (const RayPacket &packet, PacketHit &hit) const;
+
+      /**Finds silhouette of sphere seen by given ray
+       * Distance of the ray from silhouette is closest distance between
+       * the ray and center minus radius.
+       *
+       * @param ray primary ray
+       * @param range unused
+       * @param edgeDistance distance of the ray from silhouette; negative
+       *   when the ray hits sphere
+       * @param depth distance to the point of the ray closest to center
+       * @param exitDistance distance to the far intersection with sphere
+       * @return false if ray starts inside sphere or goes away from it
+       */
+      virtual bool getSilhouette (const Ray &ray,
+                                  worldUnit range,
+                                  worldUnit &edgeDistance,
+                                  worldUnit &depth,
+                                  worldUnit &exitDistance) const;
+
+      /**Returns square of sphere radius
+       *
+       * @return square radius
+       */
+      inline worldUnit getSquareRadius () const
+      {
+        return squareRadius;
+      }
+
+      /**Checks if given ray intersects with sphere with given center
+       * It's shared by sphere and objects made of many spheres.
+       *
+       * @param center center of sphere
+       * @param squareRadius square of sphere radius
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param dist temporary vector for calculations
+       * @return true if ray intersects with sphere in its range
+       */
+      static inline bool checkRay (const Point &center,
+                                   worldUnit squareRadius,
+                                   const Ray &ray,
+                                   worldUnit &range,
+                                   Vector &dist)
+      {
+        dist = center.diff(ray.getStart());
+
+        worldUnit a = ray.getDir().dotProduct(dist);
+
+        auto squareLength = dist.dotProduct();
+        worldUnit D = squareRadius - squareLength + a * a;
+
+        //There is no intersection with sphere if D < 0
+        if (D < 0.f)
+        {
+          return false;
+        }
+
+        worldUnit t = SQRT(D);
+
+        if (squareLength >= squareRadius)
+        { //We are outside sphere
+          a -= t;
+        }
+        else
+        { //We are inside sphere
+          a += t;
+        }
+
+        if ( (a > 0.0f) && (a < range))
+        {
+          range = a;
+          return true;
+        }
+
+        return false;
+      }
+
     private:
       worldUnit squareRadius;
 
@@ -0,0 +1,250 @@
+/// @file Model/SphereStore.cpp
+
+#include <limits>
+
+#include "Model/Ray.h"
+#include "Model/RayPacket.h"
+#include "Model/Sphere.h"
+#include "Model/SphereStore.h"
+
+namespace Model
+{
+
+  namespace
+  {
+    /**Ray broadcast to all SIMD lanes
+     *
+     */
+    struct BroadcastRay
+    {
+        PacketFloat startX, startY, startZ;
+        PacketFloat dirX, dirY, dirZ;
+
+        inline BroadcastRay (const Ray &ray)
+        {
+          startX = packetSet(ray.getStart() [X]);
+          startY = packetSet(ray.getStart() [Y]);
+          startZ = packetSet(ray.getStart() [Z]);
+          dirX = packetSet(ray.getDir() [X]);
+          dirY = packetSet(ray.getDir() [Y]);
+          dirZ = packetSet(ray.getDir() [Z]);
+        }
+    };
+
+    /**Lane indices used to mask out lanes past the end of a leaf
+     *
+     */
+    alignas(32) const float LANE_INDICES [] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    /**Tests ray against one block of PACKET_SIZE spheres
+     * It's the same test as Sphere::checkRay, done for all lanes at once
+     *
+     * @param ray broadcast ray
+     * @param centerX x coordinates of sphere centers
+     * @param centerY y coordinates of sphere centers
+     * @param centerZ z coordinates of sphere centers
+     * @param squareRadius square radii of spheres
+     * @param count amount of valid spheres in block
+     * @param range range of ray
+     * @param distances distances to intersections; valid where bit is set
+     * @return bit mask of intersected spheres
+     */
+    inline int checkBlock (const BroadcastRay &ray,
+                           const float *centerX,
+                           const float *centerY,
+                           const float *centerZ,
+                           const float *squareRadius,
+                           uint32_t count,
+                           worldUnit range,
+                           float *distances)
+    {
+      PacketFloat distX = packetSub(packetLoadUnaligned(centerX), ray.startX);
+      PacketFloat distY = packetSub(packetLoadUnaligned(centerY), ray.startY);
+      PacketFloat distZ = packetSub(packetLoadUnaligned(centerZ), ray.startZ);
+
+      PacketFloat a = packetAdd(
+          packetAdd(packetMul(ray.dirX, distX), packetMul(ray.dirY, distY)),
+          packetMul(ray.dirZ, distZ));
+
+      PacketFloat squareLength = packetAdd(
+          packetAdd(packetMul(distX, distX), packetMul(distY, distY)),
+          packetMul(distZ, distZ));
+
+      PacketFloat squareRadiusPacket = packetLoadUnaligned(squareRadius);
+      PacketFloat D = packetAdd(packetSub(squareRadiusPacket, squareLength),
+                                packetMul(a, a));
+
+      PacketFloat zero = packetSet(0.0f);
+      PacketFloat mask = packetAnd(
+          packetLessEqual(zero, D),
+          packetLess(packetLoad(LANE_INDICES), packetSet(count)));
+
+      if (packetMask(mask) == 0)
+      {
+        return 0;
+      }
+
+      PacketFloat t = packetSqrt(packetMax(D, zero));
+
+      //Rays starting outside sphere take closer intersection
+      PacketFloat outside = packetLessEqual(squareRadiusPacket, squareLength);
+      a = packetSelect(packetAdd(a, t), packetSub(a, t), outside);
+
+      mask = packetAnd(mask, packetLess(zero, a));
+      mask = packetAnd(mask, packetLess(a, packetSet(range)));
+
+      packetStore(distances, a);
+
+      return packetMask(mask);
+    }
+  }
+
+  bool SphereStore::isSphere (const VisibleObject *object)
+  {
+    return dynamic_cast <const Sphere *>(object) != nullptr;
+  }
+
+  void SphereStore::clear ()
+  {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    squareRadius.clear();
+    objects.clear();
+  }
+
+  size_t SphereStore::getMemoryUsage () const
+  {
+    return (centerX.capacity() + centerY.capacity() + centerZ.capacity()
+        + squareRadius.capacity()) * sizeof(float)
+        + objects.capacity() * sizeof(const VisibleObject *);
+  }
+
+  void SphereStore::build (const ObjectContainer &newObjects)
+  {
+    clear();
+
+    //Last block of leaf may be read past the end of arrays, it's masked out
+    size_t size = newObjects.size() + PACKET_SIZE;
+
+    centerX.resize(size, 0.0f);
+    centerY.resize(size, 0.0f);
+    centerZ.resize(size, 0.0f);
+    squareRadius.resize(size, -std::numeric_limits <float>::max());
+    objects = newObjects;
+
+    for (size_t i = 0; i < newObjects.size(); ++i)
+    {
+      const Sphere *sphere = dynamic_cast <const Sphere *>(newObjects [i]);
+
+      if (sphere != nullptr)
+      {
+        centerX [i] = sphere->getPosition() [X];
+        centerY [i] = sphere->getPosition() [Y];
+        centerZ [i] = sphere->getPosition() [Z];
+        squareRadius [i] = sphere->getSquareRadius();
+      }
+    }
+  }
+
+  const VisibleObject *SphereStore::findIntersection (const Ray &ray,
+                                                      uint32_t first,
+                                                      uint32_t count,
+                                                      worldUnit &range) const
+  {
+    const VisibleObject *closestObject = nullptr;
+    alignas(32) float distances [PACKET_SIZE];
+    BroadcastRay broadcastRay(ray);
+    uint32_t last = first + count;
+
+    for (uint32_t idx = first; idx < last; idx += PACKET_SIZE)
+    {
+      int bits = checkBlock(broadcastRay, &centerX [idx], &centerY [idx],
+                            &centerZ [idx], &squareRadius [idx], last - idx,
+                            range, distances);
+
+      for (int lane = 0; bits != 0; ++lane, bits >>= 1)
+      {
+        if ( (bits & 1) && distances [lane] < range)
+        {
+          range = distances [lane];
+          closestObject = objects [idx + lane];
+        }
+      }
+    }
+
+    return closestObject;
+  }
+
+  void SphereStore::findIntersections (const RayPacket &packet,
+                                       uint32_t first,
+                                       uint32_t count,
+                                       PacketHit &hit) const
+  {
+    PacketFloat zero = packetSet(0.0f);
+    uint32_t last = first + count;
+
+    //It's the same test as Sphere::checkRays
+    for (uint32_t idx = first; idx < last; ++idx)
+    {
+      PacketFloat distX = packetSub(packetSet(centerX [idx]), packet.startX);
+      PacketFloat distY = packetSub(packetSet(centerY [idx]), packet.startY);
+      PacketFloat distZ = packetSub(packetSet(centerZ [idx]), packet.startZ);
+
+      PacketFloat a = packetAdd(
+          packetAdd(packetMul(packet.dirX, distX),
+                    packetMul(packet.dirY, distY)),
+          packetMul(packet.dirZ, distZ));
+
+      PacketFloat squareLength = packetAdd(
+          packetAdd(packetMul(distX, distX), packetMul(distY, distY)),
+          packetMul(distZ, distZ));
+
+      PacketFloat squareRadiusPacket = packetSet(squareRadius [idx]);
+      PacketFloat D = packetAdd(packetSub(squareRadiusPacket, squareLength),
+                                packetMul(a, a));
+      PacketFloat mask = packetLessEqual(zero, D);
+
+      if (packetMask(mask) == 0)
+      {
+        continue;
+      }
+
+      PacketFloat t = packetSqrt(packetMax(D, zero));
+
+      //Rays starting outside sphere take closer intersection
+      PacketFloat outside = packetLessEqual(squareRadiusPacket, squareLength);
+      a = packetSelect(packetAdd(a, t), packetSub(a, t), outside);
+
+      mask = packetAnd(mask, packetLess(zero, a));
+      mask = packetAnd(mask, packetLess(a, hit.range));
+
+      hit.update(a, mask, objects [idx]);
+    }
+  }
+
+  const VisibleObject *SphereStore::findAnyIntersection (const Ray &ray,
+                                                         uint32_t first,
+                                                         uint32_t count,
+                                                         worldUnit range) const
+  {
+    alignas(32) float distances [PACKET_SIZE];
+    BroadcastRay broadcastRay(ray);
+    uint32_t last = first + count;
+
+    for (uint32_t idx = first; idx < last; idx += PACKET_SIZE)
+    {
+      int bits = checkBlock(broadcastRay, &centerX [idx], &centerY [idx],
+                            &centerZ [idx], &squareRadius [idx], last - idx,
+                            range, distances);
+
+      if (bits != 0)
+      {
+        return objects [idx + __builtin_ctz(bits)];
+      }
+    }
+
+    return nullptr;
+  }
+
+} /* namespace Model */
@@ -0,0 +1,106 @@
+/// @file Model/SphereStore.h
+
+#pragma once
+
+#include <vector>
+
+#include "Model/ModelDefines.h"
+
+namespace Model
+{
+  //Forward declarations -->
+  struct PacketHit;
+  class Ray;
+  struct RayPacket;
+  class VisibleObject;
+  // <-- Forward declarations
+
+  /**Packed sphere data
+   * Centers and square radii of spheres are kept in separate flat arrays
+   * (structure of arrays), so one ray is tested against PACKET_SIZE
+   * spheres at once, or packet of rays against one sphere, without
+   * virtual calls and pointer chasing.
+   * Entries are indexed the same way as objects in BVH leaves.
+   *
+   */
+  class SphereStore
+  {
+    public:
+      typedef std::vector <const VisibleObject *> ObjectContainer;
+
+      /**Copies data of spheres from given objects
+       * Entries of objects which aren't spheres are never hit.
+       *
+       * @param newObjects objects to copy data from
+       */
+      void build (const ObjectContainer &newObjects);
+
+      /**Removes all entries
+       *
+       */
+      void clear ();
+
+      /**Finds closest sphere which intersects with given ray
+       *
+       * @param ray ray to check intersection with
+       * @param first index of first sphere to check
+       * @param count amount of spheres to check
+       * @param range range of given ray; it's set to distance to the intersection
+       * @return closest intersected sphere or nullptr if there's no intersection
+       */
+      const VisibleObject *findIntersection (const Ray &ray,
+                                             uint32_t first,
+                                             uint32_t count,
+                                             worldUnit &range) const;
+
+      /**Finds closest spheres which intersect with packet of rays
+       * Each sphere is broadcast to all lanes, so spheres are read
+       * from packed arrays instead of being called one by one.
+       *
+       * @param packet rays to check intersection with
+       * @param first index of first sphere to check
+       * @param count amount of spheres to check
+       * @param hit closest intersections; ranges are shortened on hit
+       */
+      void findIntersections (const RayPacket &packet,
+                              uint32_t first,
+                              uint32_t count,
+                              PacketHit &hit) const;
+
+      /**Finds any sphere which intersects with given ray in given range
+       *
+       * @param ray ray to check intersection with
+       * @param first index of first sphere to check
+       * @param count amount of spheres to check
+       * @param range range of given ray
+       * @return intersected sphere or nullptr if there's no intersection
+       */
+      const VisibleObject *findAnyIntersection (const Ray &ray,
+                                                uint32_t first,
+                                                uint32_t count,
+                                                worldUnit range) const;
+
+      /**Returns true if object can be stored as a packed sphere
+       *
+       * @param object object to check
+       * @return is object a sphere
+       */
+      static bool isSphere (const VisibleObject *object);
+
+      /**Returns memory allocated by packed data
+       *
+       * @return size in bytes
+       */
+      size_t getMemoryUsage () const;
+
+    private:
+      typedef std::vector <float> FloatContainer;
+
+      FloatContainer centerX;
+      FloatContainer centerY;
+      FloatContainer centerZ;
+      FloatContainer squareRadius;
+      ObjectContainer objects;
+  };
+
+} /* namespace Model */
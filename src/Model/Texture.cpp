@@ -0,0 +1,92 @@
+/// @file Model/Texture.cpp
+
+#include <QImage>
+#include <QString>
+
+#include "Model/Texture.h"
+
+namespace Model
+{
+
+  bool Texture::load (const QString &fileName)
+  {
+    return load(QImage(fileName));
+  }
+
+  bool Texture::load (const QImage &image)
+  {
+    clear();
+
+    if (image.isNull())
+    {
+      return false;
+    }
+
+    //Single known format, so rows can be read directly
+    QImage rgbImage = image.convertToFormat(QImage::Format_RGB32);
+    std::shared_ptr <LevelContainer> data(new LevelContainer(1));
+    Level &base = data->front();
+
+    base.width = rgbImage.width();
+    base.height = rgbImage.height();
+    base.texels.resize(base.width * base.height);
+
+    for (int y = 0; y < base.height; ++y)
+    {
+      const QRgb *line = reinterpret_cast <const QRgb *>(rgbImage.constScanLine(
+          y));
+      SSEData *texel = &base.texels [y * base.width];
+
+      for (int x = 0; x < base.width; ++x)
+      {
+        texel [x] = SSEData(qRed(line [x]), qGreen(line [x]), qBlue(line [x]));
+      }
+    }
+
+    buildMipLevels( *data);
+    levels = data;
+
+    return true;
+  }
+
+  void Texture::clear ()
+  {
+    levels.reset();
+  }
+
+  void Texture::buildMipLevels (LevelContainer &data)
+  {
+    while (data.back().width > 1 || data.back().height > 1)
+    {
+      const Level &source = data.back();
+      Level level;
+
+      level.width = std::max(1, source.width / 2);
+      level.height = std::max(1, source.height / 2);
+      level.texels.resize(level.width * level.height);
+
+      for (int y = 0; y < level.height; ++y)
+      {
+        //Odd last row or column is dropped like in box filtered pyramids
+        int y0 = std::min(2 * y, source.height - 1);
+        int y1 = std::min(2 * y + 1, source.height - 1);
+
+        for (int x = 0; x < level.width; ++x)
+        {
+          int x0 = std::min(2 * x, source.width - 1);
+          int x1 = std::min(2 * x + 1, source.width - 1);
+
+          SSEData sum(source.texels [y0 * source.width + x0]);
+          sum += source.texels [y0 * source.width + x1];
+          sum += source.texels [y1 * source.width + x0];
+          sum += source.texels [y1 * source.width + x1];
+
+          level.texels [y * level.width + x] = sum * 0.25f;
+        }
+      }
+
+      data.push_back(level);
+    }
+  }
+
+} /* namespace Model */
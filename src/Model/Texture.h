@@ -0,0 +1,140 @@
+/// @file Model/Texture.h
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "Model/Color.h"
+#include "Model/SSEData.h"
+
+class QImage;
+class QString;
+
+namespace Model
+{
+
+  /**Texture decoded to float texels with mip pyramid
+   * Texels are decoded once at load time into tightly packed SSEData
+   * (one aligned load per texel), so sampling doesn't go through
+   * QImage::pixel and QRgb conversion. Every next mip level is half
+   * of the previous one, down to 1x1.
+   * Decoded levels are shared between copies of texture
+   * and between materials through TextureCache.
+   *
+   */
+  class Texture
+  {
+    public:
+      /**One level of mip pyramid
+       * Texels are stored row by row, components are in range
+       * 0 <= value <= COLOR_MAX_VALUE.
+       *
+       */
+      struct Level
+      {
+          int width;
+          int height;
+          std::vector <SSEData> texels;
+      };
+
+      typedef std::vector <Level> LevelContainer;
+
+      /**Decodes image from file and builds mip levels
+       *
+       * @param fileName image file name
+       * @return false if image can't be loaded; texture is null then
+       */
+      bool load (const QString &fileName);
+
+      /**Decodes given image and builds mip levels
+       *
+       * @param image image to decode
+       * @return false if image is null; texture is null then
+       */
+      bool load (const QImage &image);
+
+      /**Releases texels
+       *
+       */
+      void clear ();
+
+      /**Returns true if texture has no texels
+       *
+       * @return is texture null
+       */
+      inline bool isNull () const
+      {
+        return !levels;
+      }
+
+      /**Returns width of the base level
+       *
+       * @return width in texels
+       */
+      inline int getWidth () const
+      {
+        return levels->front().width;
+      }
+
+      /**Returns height of the base level
+       *
+       * @return height in texels
+       */
+      inline int getHeight () const
+      {
+        return levels->front().height;
+      }
+
+      /**Returns mip levels; the first one is the base level
+       *
+       * @return mip levels
+       */
+      inline const LevelContainer &getLevels () const
+      {
+        return *levels;
+      }
+
+      /**Returns nearest texel from mip level matching given footprint
+       * Texture can't be null.
+       *
+       * @param u horizontal coordinate, 0 <= u < 1
+       * @param v vertical coordinate, 0 <= v < 1
+       * @param texelsPerPixel amount of base level texels covered by one
+       *   pixel; values up to 1 select the base level
+       * @return color of texel
+       */
+      inline Color sample (float u, float v, float texelsPerPixel) const
+      {
+        const LevelContainer &data = *levels;
+        int levelIdx = 0;
+
+        if (texelsPerPixel >= 2.0f)
+        {
+          levelIdx = std::min(std::ilogb(texelsPerPixel),
+                              static_cast <int>(data.size()) - 1);
+        }
+
+        const Level &level = data [levelIdx];
+        int x = std::min(static_cast <int>(u * level.width), level.width - 1);
+        int y = std::min(static_cast <int>(v * level.height),
+                         level.height - 1);
+
+        return Color(SSEVector(level.texels [y * level.width + x]));
+      }
+
+    private:
+      friend class TextureCache;
+
+      std::shared_ptr <const LevelContainer> levels;
+
+      /**Appends mip levels halving the last level until it's 1x1
+       *
+       * @param data levels with the base level set
+       */
+      static void buildMipLevels (LevelContainer &data);
+  };
+
+} /* namespace Model */
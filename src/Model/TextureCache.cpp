@@ -0,0 +1,78 @@
+/// @file Model/TextureCache.cpp
+
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include "Model/TextureCache.h"
+
+namespace Model
+{
+
+  TextureCache::TextureCache ()
+  {
+  }
+
+  TextureCache &TextureCache::getInstance ()
+  {
+    static TextureCache cache;
+
+    return cache;
+  }
+
+  Texture TextureCache::getTexture (const QString &fileName)
+  {
+    Texture texture;
+    QFileInfo fileInfo(fileName);
+    QString path = fileInfo.canonicalFilePath();
+
+    //File doesn't exist
+    if (path.isEmpty())
+    {
+      return texture;
+    }
+
+    QDateTime lastModified = fileInfo.lastModified();
+    QMutexLocker locker( &mutex);
+    QHash <QString, Entry>::iterator entry = entries.find(path);
+
+    if (entry != entries.end() && entry->lastModified == lastModified)
+    {
+      texture.levels = entry->levels.lock();
+
+      if (!texture.isNull())
+      {
+        return texture;
+      }
+    }
+
+    //Decoding is done under lock, so the same file isn't decoded twice
+    if (texture.load(path))
+    {
+      removeExpired();
+
+      Entry &newEntry = entries [path];
+      newEntry.lastModified = lastModified;
+      newEntry.levels = texture.levels;
+    }
+
+    return texture;
+  }
+
+  void TextureCache::removeExpired ()
+  {
+    QHash <QString, Entry>::iterator entry = entries.begin();
+
+    while (entry != entries.end())
+    {
+      if (entry->levels.expired())
+      {
+        entry = entries.erase(entry);
+      }
+      else
+      {
+        ++entry;
+      }
+    }
+  }
+
+} /* namespace Model */
@@ -0,0 +1,62 @@
+/// @file Model/TextureCache.h
+
+#pragma once
+
+#include <memory>
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "Model/Texture.h"
+
+namespace Model
+{
+
+  /**Process wide cache of decoded textures
+   * Textures are keyed by canonical file path and modification time,
+   * so materials using the same file share one copy of texels.
+   * Cache doesn't own texels; entry expires when the last texture
+   * using it is destroyed.
+   *
+   */
+  class TextureCache
+  {
+    public:
+      /**Returns the only instance of cache
+       *
+       * @return texture cache
+       */
+      static TextureCache &getInstance ();
+
+      /**Returns texture decoded from given file
+       * File is decoded only if it isn't cached or it changed since
+       * it was decoded. It's safe to call from many threads.
+       *
+       * @param fileName image file name
+       * @return decoded texture; null texture if file can't be loaded
+       */
+      Texture getTexture (const QString &fileName);
+
+    private:
+      struct Entry
+      {
+          QDateTime lastModified;
+          std::weak_ptr <const Texture::LevelContainer> levels;
+      };
+
+      QHash <QString, Entry> entries;
+      QMutex mutex;
+
+      TextureCache ();
+
+      /**Removes entries of textures which aren't used any more
+       *
+       */
+      void removeExpired ();
+
+      Q_DISABLE_COPY (TextureCache)
+  };
+
+} /* namespace Model */
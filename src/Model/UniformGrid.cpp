@@ -0,0 +1,455 @@
+/// @file Model/UniformGrid.cpp
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Model/Ray.h"
+#include "Model/RayPacket.h"
+#include "Model/RenderStats.h"
+#include "Model/UniformGrid.h"
+#include "Model/Vector.h"
+#include "Model/VisibleObject.h"
+
+//Average amount of objects in one cell
+#define GRID_DENSITY 2.0f
+
+//Limits amount of cells on each axis
+#define GRID_MAX_RESOLUTION 512
+
+//Smaller scenes are fast enough with BVH
+#define GRID_MIN_OBJECT_COUNT 64
+
+//Grid isn't used when more cells of coarse grid are empty
+#define GRID_MAX_EMPTY_CELLS 0.5f
+
+//Grid isn't used when box of any object has bigger surface than this
+//times average surface of boxes
+#define GRID_MAX_SIZE_RATIO 16.0f
+
+namespace Model
+{
+
+  namespace
+  {
+    const Axis GRID_AXES [3] =
+      { X, Y, Z };
+
+    /**Returns cell of coordinate on axis
+     *
+     * @param local coordinate relative to grid in cells
+     * @param cellCount amount of cells on axis
+     * @return cell clamped to grid
+     */
+    inline int getCell (worldUnit local, int cellCount)
+    {
+      return std::min(std::max(static_cast <int>(std::floor(local)), 0),
+                      cellCount - 1);
+    }
+  }
+
+  UniformGrid::UniformGrid ()
+  {
+    clear();
+  }
+
+  void UniformGrid::clear ()
+  {
+    objects.clear();
+    bounds.reset();
+    cellStart.clear();
+    cellObjects.clear();
+
+    for (int i = 0; i < 3; ++i)
+    {
+      resolution [i] = 1;
+      cellSize [i] = 0.0f;
+      invCellSize [i] = 0.0f;
+    }
+  }
+
+  void UniformGrid::build (const ObjectContainer &newObjects)
+  {
+    clear();
+
+    if (newObjects.empty())
+    {
+      return;
+    }
+
+    std::vector <BoundingBox> boxes(newObjects.size());
+
+    for (size_t i = 0; i < newObjects.size(); ++i)
+    {
+      newObjects [i]->getBoundingBox(boxes [i]);
+      bounds.extend(boxes [i]);
+    }
+
+    objects = newObjects;
+    calculateResolution(bounds, newObjects.size() / GRID_DENSITY, resolution);
+
+    for (int i = 0; i < 3; ++i)
+    {
+      Axis axis = GRID_AXES [i];
+
+      cellSize [i] = (bounds.getMax() [axis] - bounds.getMin() [axis])
+          / resolution [i];
+      invCellSize [i] = cellSize [i] > 0.0f ? 1.0f / cellSize [i] : 0.0f;
+    }
+
+    //Objects are counted first, so cells can be stored in one array
+    cellStart.assign(resolution [0] * resolution [1] * resolution [2] + 1, 0);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      for (size_t objectIdx = 0; objectIdx < boxes.size(); ++objectIdx)
+      {
+        int first [3];
+        int last [3];
+        int cell [3];
+
+        for (int i = 0; i < 3; ++i)
+        {
+          Axis axis = GRID_AXES [i];
+          worldUnit min = bounds.getMin() [axis];
+
+          first [i] = getCell( (boxes [objectIdx].getMin() [axis] - min)
+                                  * invCellSize [i],
+                              resolution [i]);
+          last [i] = getCell( (boxes [objectIdx].getMax() [axis] - min)
+                                 * invCellSize [i],
+                             resolution [i]);
+        }
+
+        for (cell [2] = first [2]; cell [2] <= last [2]; ++cell [2])
+        {
+          for (cell [1] = first [1]; cell [1] <= last [1]; ++cell [1])
+          {
+            for (cell [0] = first [0]; cell [0] <= last [0]; ++cell [0])
+            {
+              uint32_t cellIdx = getCellIdx(cell);
+
+              if (pass == 0)
+              {
+                ++cellStart [cellIdx + 1];
+              }
+              else
+              {
+                cellObjects [cellStart [cellIdx]++ ] = newObjects [objectIdx];
+              }
+            }
+          }
+        }
+      }
+
+      if (pass == 0)
+      {
+        //Cell i starts where cell i - 1 ends
+        for (size_t i = 1; i < cellStart.size(); ++i)
+        {
+          cellStart [i] += cellStart [i - 1];
+        }
+
+        cellObjects.resize(cellStart.back());
+      }
+    }
+
+    //Filling moved start of each cell to start of the next one
+    for (size_t i = cellStart.size() - 1; i > 0; --i)
+    {
+      cellStart [i] = cellStart [i - 1];
+    }
+    cellStart [0] = 0;
+  }
+
+  bool UniformGrid::refit ()
+  {
+    ObjectContainer oldObjects;
+
+    oldObjects.swap(objects);
+    build(oldObjects);
+
+    return true;
+  }
+
+  size_t UniformGrid::getMemoryUsage () const
+  {
+    return cellStart.capacity() * sizeof(uint32_t)
+        + (cellObjects.capacity() + objects.capacity())
+            * sizeof(const VisibleObject *);
+  }
+
+  void UniformGrid::calculateResolution (const BoundingBox &box,
+                                         worldUnit cellCount,
+                                         int *cells)
+  {
+    worldUnit extent [3];
+    worldUnit maxExtent = 0.0f;
+
+    for (int i = 0; i < 3; ++i)
+    {
+      extent [i] = box.getMax() [GRID_AXES [i]] - box.getMin() [GRID_AXES [i]];
+      maxExtent = std::max(maxExtent, extent [i]);
+      cells [i] = 1;
+    }
+
+    if (! (maxExtent > 0.0f) || cellCount <= 1.0f)
+    {
+      return;
+    }
+
+    //Flat axes get one cell, they would make volume zero
+    worldUnit minExtent = maxExtent / GRID_MAX_RESOLUTION;
+    worldUnit volume = 1.0f;
+
+    for (int i = 0; i < 3; ++i)
+    {
+      extent [i] = std::max(extent [i], minExtent);
+      volume *= extent [i];
+    }
+
+    worldUnit cellsPerUnit = std::cbrt(cellCount / volume);
+
+    for (int i = 0; i < 3; ++i)
+    {
+      cells [i] = std::min(
+          std::max(static_cast <int>(extent [i] * cellsPerUnit + 0.5f), 1),
+          GRID_MAX_RESOLUTION);
+    }
+  }
+
+  template <typename Function>
+  void UniformGrid::walk (const Ray &ray,
+                          const worldUnit &range,
+                          Function function) const
+  {
+    Vector invDir;
+    worldUnit distance;
+
+    BoundingBox::invertDirection(ray.getDir(), invDir);
+
+    if (objects.empty() || !bounds.checkRay(ray, invDir, range, distance))
+    {
+      return;
+    }
+
+    int cell [3];
+    int step [3];
+    worldUnit next [3];
+    worldUnit delta [3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+      Axis axis = GRID_AXES [i];
+      worldUnit start = ray.getStart() [axis];
+      worldUnit dir = ray.getDir() [axis];
+      worldUnit min = bounds.getMin() [axis];
+
+      cell [i] = getCell( (start + dir * distance - min) * invCellSize [i],
+                         resolution [i]);
+
+      if (dir > 0.0f)
+      {
+        step [i] = 1;
+        next [i] = (min + (cell [i] + 1) * cellSize [i] - start) * invDir [axis];
+        delta [i] = cellSize [i] * invDir [axis];
+      }
+      else if (dir < 0.0f)
+      {
+        step [i] = -1;
+        next [i] = (min + cell [i] * cellSize [i] - start) * invDir [axis];
+        delta [i] = -cellSize [i] * invDir [axis];
+      }
+      else
+      {
+        step [i] = 0;
+        next [i] = std::numeric_limits <worldUnit>::max();
+        delta [i] = 0.0f;
+      }
+    }
+
+    while (true)
+    {
+      int i = next [0] < next [1] ? 0 : 1;
+      i = next [i] < next [2] ? i : 2;
+
+      if (function(getCellIdx(cell), next [i]) || next [i] >= range)
+      {
+        break;
+      }
+
+      cell [i] += step [i];
+
+      if (cell [i] < 0 || cell [i] >= resolution [i])
+      {
+        break;
+      }
+
+      next [i] += delta [i];
+    }
+  }
+
+  const VisibleObject *UniformGrid::findIntersection (const Ray &ray,
+                                                      worldUnit &range,
+                                                      Vector &tmpDist,
+                                                      RenderStats &stats) const
+  {
+    const VisibleObject *closestObject = nullptr;
+
+    walk(ray, range, [&] (uint32_t cellIdx, worldUnit exit)
+    {
+      const VisibleObject * const *object = cellObjects.data()
+          + cellStart [cellIdx];
+      const VisibleObject * const *lastObject = cellObjects.data()
+          + cellStart [cellIdx + 1];
+
+      RENDER_STATS_ADD(stats.intersectionTests, lastObject - object);
+
+      for (; object != lastObject; ++object)
+      {
+        if ( (*object)->checkRay(ray, range, tmpDist))
+        {
+          closestObject = *object;
+        }
+      }
+
+      //Object can stick out of the cell, its hit is accepted only when
+      //no other cell can have closer one
+      return range <= exit;
+    });
+
+    return closestObject;
+  }
+
+  void UniformGrid::findIntersections (const RayPacket &packet,
+                                       PacketHit &hit,
+                                       RenderStats &stats) const
+  {
+    alignas(32) float ranges [PACKET_SIZE];
+    Vector tmpDist;
+
+    packetStore(ranges, hit.range);
+
+    for (int lane = 0; lane < packet.rayCount; ++lane)
+    {
+      const VisibleObject *object = findIntersection(packet.rays [lane],
+                                                     ranges [lane], tmpDist,
+                                                     stats);
+
+      if (object != nullptr)
+      {
+        hit.objects [lane] = object;
+      }
+    }
+
+    hit.range = packetLoad(ranges);
+  }
+
+  const VisibleObject *UniformGrid::findAnyIntersection (const Ray &ray,
+                                                         worldUnit range,
+                                                         Vector &tmpDist,
+                                                         RenderStats &stats) const
+  {
+    const VisibleObject *occluder = nullptr;
+
+    walk(ray, range, [&] (uint32_t cellIdx, worldUnit)
+    {
+      const VisibleObject * const *object = cellObjects.data()
+          + cellStart [cellIdx];
+      const VisibleObject * const *lastObject = cellObjects.data()
+          + cellStart [cellIdx + 1];
+
+      RENDER_STATS_ADD(stats.intersectionTests, lastObject - object);
+
+      for (; object != lastObject; ++object)
+      {
+        //checkRay shortens range on hit, each object gets its own copy
+        worldUnit objectRange = range;
+
+        if ( (*object)->checkRay(ray, objectRange, tmpDist))
+        {
+          occluder = *object;
+          return true;
+        }
+      }
+
+      return false;
+    });
+
+    return occluder;
+  }
+
+  bool UniformGrid::isSuitable (const ObjectContainer &newObjects)
+  {
+    if (newObjects.size() < GRID_MIN_OBJECT_COUNT)
+    {
+      return false;
+    }
+
+    BoundingBox box, centerBounds;
+    std::vector <Point> centers;
+    worldUnit areaSum = 0.0f, maxArea = 0.0f;
+
+    centers.reserve(newObjects.size());
+
+    for (const VisibleObject *object : newObjects)
+    {
+      object->getBoundingBox(box);
+      centers.push_back(box.getCenter());
+      centerBounds.extend(centers.back());
+
+      worldUnit area = box.getSurfaceArea();
+      areaSum += area;
+      maxArea = std::max(maxArea, area);
+    }
+
+    if (maxArea > GRID_MAX_SIZE_RATIO * areaSum / newObjects.size())
+    {
+      return false;
+    }
+
+    //Coarse grid has one cell per object
+    int cells [3];
+    worldUnit invSize [3];
+
+    calculateResolution(centerBounds, newObjects.size(), cells);
+
+    for (int i = 0; i < 3; ++i)
+    {
+      Axis axis = GRID_AXES [i];
+      worldUnit extent = centerBounds.getMax() [axis]
+          - centerBounds.getMin() [axis];
+
+      invSize [i] = extent > 0.0f ? cells [i] / extent : 0.0f;
+    }
+
+    std::vector <bool> occupied(cells [0] * cells [1] * cells [2], false);
+    size_t occupiedCount = 0;
+
+    for (const Point &center : centers)
+    {
+      int cell [3];
+
+      for (int i = 0; i < 3; ++i)
+      {
+        Axis axis = GRID_AXES [i];
+
+        cell [i] = getCell( (center [axis] - centerBounds.getMin() [axis])
+                               * invSize [i],
+                           cells [i]);
+      }
+
+      size_t cellIdx = (cell [2] * cells [1] + cell [1]) * cells [0] + cell [0];
+
+      if (!occupied [cellIdx])
+      {
+        occupied [cellIdx] = true;
+        ++occupiedCount;
+      }
+    }
+
+    return occupiedCount
+        >= (1.0f - GRID_MAX_EMPTY_CELLS) * static_cast <float>(occupied.size());
+  }
+
+} /* namespace Model */
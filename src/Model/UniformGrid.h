@@ -0,0 +1,158 @@
+/// @file Model/UniformGrid.h
+
+#pragma once
+
+#include <vector>
+
+#include "Model/Accelerator.h"
+#include "Model/BoundingBox.h"
+#include "Model/ModelDefines.h"
+
+namespace Model
+{
+
+  /**Regular grid of cells walked with 3D-DDA
+   * Each cell keeps objects whose bounding boxes overlap it. Grid is
+   * built in linear time and its traversal doesn't depend on depth of
+   * any tree, so it's faster than BVH for uniformly distributed objects
+   * of similar size, e.g. lattices of spheres.
+   *
+   */
+  class UniformGrid: public Accelerator
+  {
+    public:
+      UniformGrid ();
+
+      inline virtual ~UniformGrid ()
+      {
+      }
+
+      /**Builds grid over given objects
+       * There are about GRID_DENSITY objects per cell.
+       *
+       * @param newObjects objects to build grid over
+       */
+      virtual void build (const ObjectContainer &newObjects);
+
+      /**Builds grid again, it's as fast as refit of tree
+       *
+       * @return always true
+       */
+      virtual bool refit ();
+
+      virtual void clear ();
+
+      /**Finds closest object which intersects with given ray
+       * Cells are visited in order along the ray, so walk stops in the
+       * first cell which contains intersection.
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray; it's set to distance to the intersection
+       * @param tmpDist temporary vector for calculations
+       * @param stats counters of intersection tests
+       * @return closest intersected object or nullptr if there's no intersection
+       */
+      virtual const VisibleObject *findIntersection (const Ray &ray,
+                                                     worldUnit &range,
+                                                     Vector &tmpDist,
+                                                     RenderStats &stats) const;
+
+      /**Finds closest objects which intersect with packet of rays
+       * Rays of packet diverge in grid, so each one walks its own cells.
+       *
+       * @param packet rays to check intersection with
+       * @param hit closest intersections; ranges are shortened on hit
+       * @param stats counters of intersection tests
+       */
+      virtual void findIntersections (const RayPacket &packet,
+                                      PacketHit &hit,
+                                      RenderStats &stats) const;
+
+      /**Finds any object which intersects with given ray in given range
+       *
+       * @param ray ray to check intersection with
+       * @param range range of given ray
+       * @param tmpDist temporary vector for calculations
+       * @param stats counters of intersection tests
+       * @return intersected object or nullptr if there's no intersection
+       */
+      virtual const VisibleObject *findAnyIntersection (const Ray &ray,
+                                                        worldUnit range,
+                                                        Vector &tmpDist,
+                                                        RenderStats &stats) const;
+
+      inline virtual bool isEmpty () const
+      {
+        return objects.empty();
+      }
+
+      /**Returns memory allocated by cells
+       *
+       * @return size in bytes
+       */
+      virtual size_t getMemoryUsage () const;
+
+      /**Checks if objects are distributed uniformly enough for grid
+       * Centers of objects are counted in cells of coarse grid. Grid is
+       * suitable when few cells are empty and sizes of objects are
+       * similar, otherwise BVH adapts better to the scene.
+       *
+       * @param newObjects bounded objects
+       * @return true if grid should be used instead of BVH
+       */
+      static bool isSuitable (const ObjectContainer &newObjects);
+
+    private:
+      typedef std::vector <uint32_t> IndexContainer;
+
+      ObjectContainer objects;
+      BoundingBox bounds;
+
+      /**Amount of cells on X, Y and Z axis
+       *
+       */
+      int resolution [3];
+      worldUnit cellSize [3];
+      worldUnit invCellSize [3];
+
+      /**Objects of cell i are cellObjects [cellStart [i]] up to
+       * cellObjects [cellStart [i + 1]]
+       *
+       */
+      IndexContainer cellStart;
+      ObjectContainer cellObjects;
+
+      /**Calculates amount of cells on each axis
+       *
+       * @param box bounds of grid
+       * @param cellCount wanted amount of cells
+       * @param cells amount of cells on X, Y and Z axis
+       */
+      static void calculateResolution (const BoundingBox &box,
+                                       worldUnit cellCount,
+                                       int *cells);
+
+      /**Returns index of cell
+       *
+       * @param cell cell coordinates on X, Y and Z axis
+       * @return index of cell
+       */
+      inline uint32_t getCellIdx (const int *cell) const
+      {
+        return (cell [2] * resolution [1] + cell [1]) * resolution [0]
+            + cell [0];
+      }
+
+      /**Walks cells pierced by ray
+       * Function gets objects of each cell and returns true to stop.
+       *
+       * @param ray ray to walk with
+       * @param range range of ray; it can be shortened by function
+       * @param function function called with cell index and distance
+       * to exit of the cell
+       */
+      template <typename Function>
+      void walk (const Ray &ray, const worldUnit &range, Function function) const;
+  };
+
+} /* namespace Model */
@@ -3,13 +3,14 @@
 #pragma once
 
 #include "Model/Object.h"
+#include "Model/RayPacket.h"
+#include "Model/Vector.h"
 
 namespace Model
 {
   //Forward declarations -->
+  class BoundingBox;
   class Point;
-  class Ray;
-  class Vector;
   // <-- Forward declarations
 
   /**Visible object class
@@ -22,6 +23,13 @@ namespace Model
       const Material *material;
 
     public:
+      /**Unbounded objects keep size 0
+       *
+       */
+      inline VisibleObject ()
+          : material(nullptr), size(0)
+      {
+      }
 
       inline virtual ~VisibleObject ()
       {
@@ -53,6 +61,61 @@ namespace Model
       virtual void getNormal (const Point& point,
                               Vector &normalAtPoint) const = 0;
 
+      /**Calculates bounding box of the object
+       * Unbounded objects (e.g. planes) return false and can't be
+       * placed in acceleration structures
+       *
+       * @param box box to calculate bounds in
+       * @return true if object is bounded, otherwise false
+       */
+      virtual bool getBoundingBox (BoundingBox &box) const = 0;
+
+      /**Returns object whose surface was hit and normal at intersection
+       * Objects made of other objects return the hit part, so its
+       * material and size are used for shading.
+       *
+       * @param ray ray which hit the object
+       * @param distance distance to the intersection
+       * @param point intersection point
+       * @param normalAtPoint vector to calculate normal in
+       * @param size size of hit object in scene space; it differs from
+       * its getSize when the object is scaled
+       * @return hit object
+       */
+      virtual const VisibleObject &getHitSurface (const Ray &,
+                                                  worldUnit,
+                                                  const Point &point,
+                                                  Vector &normalAtPoint,
+                                                  worldUnit &size) const
+      {
+        getNormal(point, normalAtPoint);
+        size = getSize();
+
+        return *this;
+      }
+
+      /**Finds silhouette of the object seen by given ray
+       * It's used by analytic anti-aliasing to estimate which part of
+       * pixel is covered by the object. Objects without analytic
+       * silhouette return false.
+       *
+       * @param ray primary ray
+       * @param range range of given ray
+       * @param edgeDistance distance of the ray from silhouette; negative
+       *   when the ray hits the object
+       * @param depth distance to silhouette along the ray
+       * @param exitDistance distance along the ray where it leaves the object
+       * @return true if the object has silhouette in front of ray start
+       */
+      virtual bool getSilhouette (const Ray &,
+                                  worldUnit,
+                                  worldUnit &,
+                                  worldUnit &,
+                                  worldUnit &) const
+      {
+        return false;
+      }
+
       /**Sets material of the object
        *
        * @param newMaterialId id of material to set
@@ -73,6 +136,29 @@ namespace Model
                              worldUnit &range,
                              Vector &tmpDist) const = 0;
 
+      /**Checks intersections of packet of rays with the object
+       * Closer intersections are stored in hit.
+       * Default implementation checks rays one by one; objects with
+       * SIMD friendly intersection test should override it.
+       *
+       * @param packet rays to check intersection with
+       * @param hit closest intersections found so far
+       */
+      virtual void checkRays (const RayPacket &packet, PacketHit &hit) const
+      {
+        Vector tmpDist;
+
+        for (int lane = 0; lane < packet.rayCount; ++lane)
+        {
+          worldUnit range = hit.getRange(lane);
+
+          if (checkRay(packet.rays [lane], range, tmpDist))
+          {
+            hit.update(lane, range, this);
+          }
+        }
+      }
+
     protected:
       worldUnit size;
   };